@@ -0,0 +1,203 @@
+// Player Core Microbenchmark.
+//
+// Runs the same combination backtracking (budget pruning only, no bounds) on
+// the legacy layout, with string dispatch and vector<Player> per position
+// returned by value, and on the shared core, with Position enum lookups over
+// struct-of-arrays columns. Both visit the same nodes up to a node limit, so
+// the ratio of their times is the speedup of the search loop itself.
+//
+// Usage: bench_core data_base.txt query.txt [node_limit]
+
+#include "players.hh"
+using namespace std;
+
+// Legacy definition of soccer player class.
+struct Player {
+  string name;
+  string position;
+  int price;
+  string team;
+  int points;
+};
+
+// Legacy definition of player database data structure.
+struct Legacy_database {
+  vector<Player> porters;
+  vector<Player> defenses;
+  vector<Player> migcampistes;
+  vector<Player> davanters;
+};
+
+// Legacy definition of partial solution data structure.
+struct Legacy_solution {
+  int def_count = 0;
+  int mig_count = 0;
+  int dav_count = 0;
+  int por_count = 0;
+  int current_price = 0;
+  int current_points = 0;
+  vector<Player> players;
+};
+
+long long node_limit = 2000000;
+long long visited_nodes;
+int best_points;
+
+// Builds the legacy layout from the core one, keeping the same player order.
+Legacy_database legacy_database(const Player_database &database) {
+  Legacy_database legacy;
+  array<vector<Player> *, N_POSITIONS> vectors = {
+      &legacy.porters, &legacy.defenses, &legacy.migcampistes,
+      &legacy.davanters};
+  for (Position position : POSITIONS) {
+    const Position_players &players = database[position];
+    for (int i = 0; i < players.size(); ++i)
+      vectors[position]->push_back({database.names[players.name[i]],
+                                    POSITION_NAMES[position], players.price[i],
+                                    "", players.points[i]});
+  }
+  return legacy;
+}
+
+vector<Player> get_players(const Legacy_database &database, string position) {
+  if (position == "def")
+    return database.defenses;
+  else if (position == "mig")
+    return database.migcampistes;
+  else if (position == "dav")
+    return database.davanters;
+  else if (position == "por")
+    return database.porters;
+  return {};
+}
+
+int &get_count(Legacy_solution &feasible_solution, string position) {
+  if (position == "def")
+    return feasible_solution.def_count;
+  else if (position == "mig")
+    return feasible_solution.mig_count;
+  else if (position == "dav")
+    return feasible_solution.dav_count;
+  else
+    return feasible_solution.por_count;
+}
+
+int get_query_constraint(const Query &query_constraints, string position) {
+  return query_constraints.slots[parse_position(position)];
+}
+
+void legacy_backtracking(const Legacy_database &database,
+                         const Query &query_constraints,
+                         Legacy_solution &feasible_solution,
+                         const vector<string> &positions, int idx, int first) {
+  if (++visited_nodes > node_limit)
+    return;
+  if (int(feasible_solution.players.size()) == 11) {
+    best_points = max(best_points, feasible_solution.current_points);
+    return;
+  }
+
+  string position = positions[idx];
+  const vector<Player> &players = get_players(database, position);
+  if (get_count(feasible_solution, position) <
+      get_query_constraint(query_constraints, position)) {
+    for (int i = first; i < int(players.size()); ++i) {
+      if (feasible_solution.current_price + players[i].price <=
+          query_constraints.total_limit) {
+        feasible_solution.players.push_back(players[i]);
+        get_count(feasible_solution, position)++;
+        feasible_solution.current_price += players[i].price;
+        feasible_solution.current_points += players[i].points;
+
+        legacy_backtracking(database, query_constraints, feasible_solution,
+                            positions, idx, i + 1);
+
+        feasible_solution.current_price -= players[i].price;
+        feasible_solution.current_points -= players[i].points;
+        get_count(feasible_solution, position)--;
+        feasible_solution.players.pop_back();
+      }
+    }
+  } else if (idx + 1 < int(positions.size())) {
+    legacy_backtracking(database, query_constraints, feasible_solution,
+                        positions, idx + 1, 0);
+  }
+}
+
+// Core partial solution, as in exh.cc.
+struct Core_solution {
+  array<int, N_POSITIONS> counts = {};
+  int current_price = 0;
+  int current_points = 0;
+  vector<Lineup_player> players;
+};
+
+void core_backtracking(const Player_database &database,
+                       const Query &query_constraints,
+                       Core_solution &feasible_solution, int idx, int first) {
+  if (++visited_nodes > node_limit)
+    return;
+  if (int(feasible_solution.players.size()) == 11) {
+    best_points = max(best_points, feasible_solution.current_points);
+    return;
+  }
+
+  Position position = POSITIONS[idx];
+  const Position_players &players = database[position];
+  if (feasible_solution.counts[position] < query_constraints.slots[position]) {
+    for (int i = first; i < players.size(); ++i) {
+      if (feasible_solution.current_price + players.price[i] <=
+          query_constraints.total_limit) {
+        feasible_solution.players.push_back({position, i});
+        feasible_solution.counts[position]++;
+        feasible_solution.current_price += players.price[i];
+        feasible_solution.current_points += players.points[i];
+
+        core_backtracking(database, query_constraints, feasible_solution, idx,
+                          i + 1);
+
+        feasible_solution.current_price -= players.price[i];
+        feasible_solution.current_points -= players.points[i];
+        feasible_solution.counts[position]--;
+        feasible_solution.players.pop_back();
+      }
+    }
+  } else if (idx + 1 < N_POSITIONS) {
+    core_backtracking(database, query_constraints, feasible_solution, idx + 1,
+                      0);
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    cout << "Syntax: " << argv[0] << " data_base.txt query.txt [node_limit]"
+         << endl;
+    exit(1);
+  }
+  if (argc > 3)
+    node_limit = stoll(argv[3]);
+
+  Query query_constraints = read_query(argv[2]);
+  Player_database database = read_data_base(argv[1], query_constraints);
+  Legacy_database legacy = legacy_database(database);
+
+  visited_nodes = best_points = 0;
+  double start = now();
+  Legacy_solution legacy_solution;
+  legacy_backtracking(legacy, query_constraints, legacy_solution,
+                      {"por", "def", "mig", "dav"}, 0, 0);
+  double legacy_time = now() - start;
+  long long legacy_nodes = visited_nodes;
+
+  visited_nodes = best_points = 0;
+  start = now();
+  Core_solution core_solution;
+  core_backtracking(database, query_constraints, core_solution, 0, 0);
+  double core_time = now() - start;
+
+  cout << "legacy: " << legacy_nodes << " nodes in " << legacy_time << " s ("
+       << legacy_nodes / legacy_time << " nodes/s)" << endl;
+  cout << "core:   " << visited_nodes << " nodes in " << core_time << " s ("
+       << visited_nodes / core_time << " nodes/s)" << endl;
+  cout << "speedup: " << legacy_time / core_time << "x" << endl;
+}
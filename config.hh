@@ -0,0 +1,70 @@
+// Solver Configuration.
+//
+// Settings are read from a file of "section.key value" lines, as written by
+// the tuner, and overridden by the "--key value" options of the command line.
+
+#ifndef CONFIG_HH
+#define CONFIG_HH
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+using namespace std;
+
+// Solver settings, values by key.
+typedef map<string, string> Config;
+
+// Configuration file the solvers load at startup, unless given --config.
+const string DEFAULT_CONFIG_FILE = "solvers.cfg";
+
+/* Reads a configuration file of "key value" lines, as written by the tuner,
+   ignoring blank lines and # comments. A missing file is an empty one. */
+inline Config read_config(const string &config_file) {
+  Config config;
+  ifstream in(config_file);
+  string line;
+  while (getline(in, line)) {
+    istringstream fields(line);
+    string key, value;
+    if (fields >> key >> value and key[0] != '#')
+      config[key] = value;
+  }
+  return config;
+}
+
+/* Settings of a solver: the "section.key value" entries of the configuration
+   file, overridden by the "--key value" pairs of the command line from
+   argv[first] on. */
+inline Config solver_settings(const string &section, int argc, char **argv,
+                              int first) {
+  string config_file = DEFAULT_CONFIG_FILE;
+  for (int i = first; i + 1 < argc; i += 2)
+    if (string(argv[i]) == "--config")
+      config_file = argv[i + 1];
+
+  Config settings;
+  for (const auto &[key, value] : read_config(config_file))
+    if (key.compare(0, section.size() + 1, section + ".") == 0)
+      settings[key.substr(section.size() + 1)] = value;
+  for (int i = first; i + 1 < argc; i += 2) {
+    string option = argv[i];
+    if (option.compare(0, 2, "--") == 0)
+      settings[option.substr(2)] = argv[i + 1];
+  }
+  return settings;
+}
+
+// Value of a setting, or the default if it is not set.
+inline string setting(const Config &settings, const string &key,
+                      const string &default_value) {
+  auto entry = settings.find(key);
+  return entry == settings.end() ? default_value : entry->second;
+}
+inline double setting(const Config &settings, const string &key,
+                      double default_value) {
+  auto entry = settings.find(key);
+  return entry == settings.end() ? default_value : stod(entry->second);
+}
+
+#endif
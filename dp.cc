@@ -0,0 +1,244 @@
+// Dynamic Programming Algorithm.
+//
+// Exact pseudo-polynomial solver. Every position is solved as a knapsack that
+// picks exactly the required amount of players, giving the best value of each
+// exact weight; the four position tables are then merged with max-plus
+// convolutions. The weight is either the price (on the common price grid) or
+// the points, whichever needs fewer cells, so the runtime does not depend on
+// how tight the budget is. When both are too fine, prices are rounded up to a
+// coarser grid, which keeps every reported lineup feasible.
+
+#include "players.hh"
+
+#include <climits>
+using namespace std;
+
+// Definition of solution data structure.
+struct Solution {
+  double time;
+  int price = 0;
+  int points = 0;
+  vector<Lineup_player> players;
+};
+
+/* Weight dimension of the knapsacks. PRICE maximises points over exact price
+   cells; POINTS minimises the price (maximises its negation) over exact point
+   totals. */
+enum Dimension { PRICE, POINTS };
+
+// Value of the unreachable cells.
+const long long UNREACHABLE = LLONG_MIN / 4;
+
+// Largest amount of weight cells a table may have.
+const int MAX_CELLS = 1 << 13;
+
+/* Best value of a position for every exact weight, choosing exactly 'slots'
+   players, together with the players achieving it. */
+struct Position_table {
+  vector<long long> value;
+  vector<vector<int>> chosen;
+};
+
+/* Combination of several positions: best value of every exact weight and, for
+   backtracking, the weight taken from the last merged position. */
+struct Merged_table {
+  vector<long long> value;
+  vector<vector<int>> split;
+};
+
+// Declaration of output file and timing
+string output_file;
+double start_time, end_time;
+
+// Given a solution prints itself and its timing in the required format.
+void write_solution(const Player_database &database, const Solution &solution) {
+  write_lineup(output_file, database, solution.players, solution.points,
+               solution.price, solution.time);
+}
+
+/* Solves the knapsack of a single position: for every exact weight, the best
+   value of choosing exactly 'slots' of the given players. Weights beyond
+   'cells' are discarded. */
+Position_table solve_position(const vector<int> &weights,
+                              const vector<long long> &values, int slots,
+                              int cells) {
+  int n = weights.size();
+
+  /* best[k][w]: best value of k players of weight w among those processed.
+     taken[i][k][w]: whether player i is part of that best choice. */
+  vector<vector<long long>> best(slots + 1,
+                                 vector<long long>(cells + 1, UNREACHABLE));
+  vector<vector<vector<bool>>> taken(
+      n, vector<vector<bool>>(slots + 1, vector<bool>(cells + 1, false)));
+  best[0][0] = 0;
+
+  for (int i = 0; i < n; ++i) {
+    // Classic 0/1 knapsack update, downwards so each player is used once.
+    for (int k = min(slots, i + 1); k >= 1; --k) {
+      for (int w = cells; w >= weights[i]; --w) {
+        long long previous = best[k - 1][w - weights[i]];
+        if (previous != UNREACHABLE and previous + values[i] > best[k][w]) {
+          best[k][w] = previous + values[i];
+          taken[i][k][w] = true;
+        }
+      }
+    }
+  }
+
+  // Recovers the players of every reachable weight.
+  Position_table table;
+  table.value = best[slots];
+  table.chosen.resize(cells + 1);
+  for (int w = 0; w <= cells; ++w) {
+    if (table.value[w] == UNREACHABLE)
+      continue;
+    int k = slots, weight = w;
+    for (int i = n - 1; i >= 0 and k > 0; --i) {
+      if (taken[i][k][weight]) {
+        table.chosen[w].push_back(i);
+        weight -= weights[i];
+        --k;
+      }
+    }
+  }
+  return table;
+}
+
+/* Max-plus convolution of the merged table with the table of one more
+   position, keeping weights up to 'cells'. */
+void merge_position(Merged_table &merged, const Position_table &table,
+                    int cells) {
+  vector<long long> value(cells + 1, UNREACHABLE);
+  vector<int> split(cells + 1, -1);
+
+  for (int a = 0; a <= cells; ++a) {
+    if (merged.value[a] == UNREACHABLE)
+      continue;
+    for (int b = 0; a + b <= cells; ++b) {
+      if (table.value[b] == UNREACHABLE)
+        continue;
+      if (merged.value[a] + table.value[b] > value[a + b]) {
+        value[a + b] = merged.value[a] + table.value[b];
+        split[a + b] = b;
+      }
+    }
+  }
+  merged.value = value;
+  merged.split.push_back(split);
+}
+
+// Sum of the 'slots' largest points among the given players.
+int best_points_sum(const Position_players &players, int slots) {
+  vector<int> points = players.points;
+  sort(points.begin(), points.end(), greater<int>());
+  return accumulate(points.begin(),
+                    points.begin() + min(slots, int(points.size())), 0);
+}
+
+// Main algorithm concerning dynamic programming.
+void dynamic_programming(const Player_database &database,
+                         const Query &query_constraints, Solution &solution) {
+  const array<int, N_POSITIONS> &slots = query_constraints.slots;
+  int total_limit = query_constraints.total_limit;
+
+  // Cells needed by each dimension: the price grid and the points total.
+  int unit = 0, points_cells = 0;
+  for (Position position : POSITIONS) {
+    for (int price : database[position].price)
+      unit = gcd(unit, price);
+    points_cells += best_points_sum(database[position], slots[position]);
+  }
+  if (unit == 0)
+    unit = 1;
+  long long price_cells = total_limit / unit;
+
+  /* Picks the cheapest exact dimension, or scales the prices (rounding them up
+     so that the budget is never exceeded) when both are too large. */
+  Dimension dimension = PRICE;
+  bool exact = true;
+  if (price_cells > MAX_CELLS and points_cells <= MAX_CELLS) {
+    dimension = POINTS;
+  } else if (price_cells > MAX_CELLS) {
+    unit = (total_limit + MAX_CELLS - 1) / MAX_CELLS;
+    exact = false;
+  }
+  int cells = dimension == PRICE ? total_limit / unit : points_cells;
+
+  // Solves every position and merges them.
+  Merged_table merged;
+  merged.value.assign(cells + 1, UNREACHABLE);
+  merged.value[0] = 0;
+  vector<Position_table> tables;
+  for (Position position : POSITIONS) {
+    const Position_players &players = database[position];
+    vector<int> weights;
+    vector<long long> values;
+    for (int i = 0; i < players.size(); ++i) {
+      if (dimension == PRICE) {
+        weights.push_back((players.price[i] + unit - 1) / unit);
+        values.push_back(players.points[i]);
+      } else {
+        weights.push_back(players.points[i]);
+        values.push_back(-players.price[i]);
+      }
+    }
+    tables.push_back(solve_position(weights, values, slots[position], cells));
+    merge_position(merged, tables[position], cells);
+  }
+
+  // Best reachable cell: highest points for PRICE, within budget for POINTS.
+  int best_cell = -1;
+  for (int w = 0; w <= cells; ++w) {
+    if (merged.value[w] == UNREACHABLE)
+      continue;
+    if (dimension == PRICE) {
+      if (best_cell == -1 or merged.value[w] > merged.value[best_cell])
+        best_cell = w;
+    } else if (-merged.value[w] <= total_limit) {
+      best_cell = w;
+    }
+  }
+  if (best_cell == -1) {
+    cerr << "No lineup satisfies the query constraints." << endl;
+    return;
+  }
+
+  // Backtracks the weight of every position from the last one.
+  for (int p = N_POSITIONS - 1, w = best_cell; p >= 0; --p) {
+    Position position = POSITIONS[p];
+    int b = merged.split[p][w];
+    for (int i : tables[p].chosen[b]) {
+      solution.players.push_back({position, i});
+      solution.price += database[position].price[i];
+      solution.points += database[position].points[i];
+    }
+    w -= b;
+  }
+
+  end_time = now();
+  solution.time = end_time - start_time;
+  write_solution(database, solution);
+
+  cerr << (dimension == PRICE ? "Price" : "Points") << " cells: " << cells
+       << (exact ? "" : " (prices scaled, lineup may be suboptimal)") << endl;
+}
+
+int main(int argc, char **argv) {
+  string data_base;
+  string query;
+
+  data_base = argv[1];
+  query = argv[2];
+  output_file = argv[3];
+
+  /* Firstly reads the query to store player limit. Allows us to filter them
+     during the database reading process. */
+  Query query_constraints = read_query(query);
+  Player_database database = read_data_base(data_base, query_constraints);
+  reduce_candidates(database, query_constraints);
+
+  // Algorithm execution, solution writting, and timing.
+  start_time = now();
+  Solution solution;
+  dynamic_programming(database, query_constraints, solution);
+}
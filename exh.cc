@@ -1,308 +1,268 @@
 // Exhaustive Search Algorithm.
 // Authors: Lluc Palou and Ramon Ventura.
 
-#include <algorithm>
-#include <cassert>
-#include <cmath>
-#include <ctime>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
-#include <string>
-#include <unordered_map>
-#include <vector>
+#include "config.hh"
+#include "greedy.hh"
+#include "solution_writer.hh"
+
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
 using namespace std;
 
-// Definition of soccer player class.
-struct Player {
-  string name;
-  string position;
-  int price;
-  string team;
-  int points;
-};
-
-// Definition of player database data structure.
-struct Player_database {
-  vector<Player> porters;
-  vector<Player> defenses;
-  vector<Player> migcampistes;
-  vector<Player> davanters;
-};
-
-// Definition and goalkeeper initialisation of query data structure.
-struct Query {
-  int def;
-  int mig;
-  int dav;
-  int por = 1;
-  int total_limit;
-  int player_limit;
-};
-
 // Definition and initialisation of partial solution data structure.
 struct Partial_solution {
   double time;
-  int def_count = 0;
-  int mig_count = 0;
-  int dav_count = 0;
-  int por_count = 0;
+  array<int, N_POSITIONS> counts = {};
   int current_price = 0;
   int current_points = 0;
-  int best_points = 0;
-  vector<Player> players;
-};
-
-// Definition of used players data structure.
-struct Used_players {
-  vector<bool> porters;
-  vector<bool> defenses;
-  vector<bool> migcampistes;
-  vector<bool> davanters;
+  long long visited_nodes = 0;
+  vector<Lineup_player> players;
 };
 
-// Declaration of output file and timing
-string output_file;
-double start_time, end_time;
-double now() { return clock() / double(CLOCKS_PER_SEC); }
-
-/* Returns the most efficient player based on the following criteria, used to
-sort the player database. */
-bool compare_players_efficiency(const Player &a, const Player &b) {
-  /* Ordering criteria: Efficciency points/price ratio with a penalization to
-     expensive players. By manually experimenting with roots, the power
-     function (0.35) has shown to be very effective. */
-
-  // If both players have 0 points, order them based on price.
-  if (a.points == 0 and b.points == 0) {
-    return a.price < b.price;
-  }
+// Deepest split of the search tree into subtrees: goalkeeper, first defender.
+const int MAX_SPLIT_DEPTH = 2;
 
-  // If one player has 0 points, it should be considered less efficient.
-  if (a.points == 0) {
-    return false;
-  } else if (b.points == 0) {
-    return true;
-
-  } else {
-    double efficiency_a = (a.points * 1.0) / pow(a.price, 0.35);
-    double efficiency_b = (b.points * 1.0) / pow(b.price, 0.35);
-    return efficiency_a > efficiency_b;
-  }
-}
+/* Root of a search subtree: the players fixed before it, and where the
+   backtracking resumes from. Kept flat, as there can be many of them. */
+struct Subtree {
+  array<Lineup_player, MAX_SPLIT_DEPTH> prefix;
+  int size;
+  int idx;
+  int first;
+};
 
-// Applies ordering criteria to each of the vectors of positions.
-void sort_players(Player_database &data_base) {
-  sort(data_base.porters.begin(), data_base.porters.end(),
-       compare_players_efficiency);
-  sort(data_base.defenses.begin(), data_base.defenses.end(),
-       compare_players_efficiency);
-  sort(data_base.migcampistes.begin(), data_base.migcampistes.end(),
-       compare_players_efficiency);
-  sort(data_base.davanters.begin(), data_base.davanters.end(),
-       compare_players_efficiency);
-}
+/* Subtrees owned by a worker. The owner takes them from the front, in search
+   order, while idle workers steal from the back. */
+struct Worker_queue {
+  mutex lock;
+  deque<Subtree> subtrees;
+};
 
-/* Reads and stores the soccer player database. Discards players that surpass
-   the player limit price. */
-Player_database read_data_base(string data_base, Query query_constraints) {
-  Player_database database;
+/* Point of a price/points Pareto frontier. For a single position, 'left' is
+   the last pick of its chain of players. For a half of the lineup, 'left'
+   and 'right' are the entries of the two combined positions. */
+struct Frontier_entry {
+  int price;
+  int points;
+  int left;
+  int right;
+};
 
-  ifstream in(data_base);
-  while (not in.eof()) {
-    Player player;
+// Pareto frontier: entries by increasing price with increasing points.
+typedef vector<Frontier_entry> Frontier;
 
-    // Reads raw soccer player data.
-    getline(in, player.name, ';');
-    if (player.name == "")
-      break;
-    getline(in, player.position, ';');
-    in >> player.price;
-    char aux;
-    in >> aux;
-    getline(in, player.team, ';');
-    in >> player.points;
-    string aux2;
-    getline(in, aux2);
-
-    // Price restriction
-    if (player.price <= query_constraints.player_limit) {
-      if (player.position == "por") {
-        database.porters.push_back(player);
-      } else if (player.position == "def") {
-        database.defenses.push_back(player);
-      } else if (player.position == "mig") {
-        database.migcampistes.push_back(player);
-      } else if (player.position == "dav") {
-        database.davanters.push_back(player);
-      }
-    }
-  }
-  in.close();
+// Player chosen by a frontier entry, linked to the previous pick.
+struct Pick {
+  int player;
+  int previous;
+};
 
-  // Sorts database accordingly to the ordering criteria.
-  sort_players(database);
-  return database;
-}
+// Declaration of output file and timing (wall-clock, shared by all workers).
+string output_file;
+double start_time, end_time;
 
-// Reads the given query. That is, player configurations and price condavaints.
-Query read_query(string query) {
-  Query query_constraints;
+// Writes the improved lineups off the search threads.
+Solution_writer solution_writer;
+
+/* Incumbent shared by every worker. best_points is read without locking to
+   prune, and only updated (together with the published lineup) under the
+   lock. */
+atomic<int> best_points(0);
+mutex incumbent_lock;
+
+/* Wall-clock deadline of the search. Once it is reached every worker leaves
+   its remaining nodes open, and open_bound keeps the best points any of them
+   could still reach (guarded by the incumbent lock). */
+double deadline = numeric_limits<double>::infinity();
+atomic<bool> timed_out(false);
+int open_bound = 0;
+
+// Time reserved to unwind the search and flush the lineup before the deadline.
+const double DEADLINE_MARGIN = 0.05;
+
+/* Amount of nodes a worker visits between two clock checks (minus one). The
+   node counter of a worker runs across all its subtrees. */
+const long long CLOCK_INTERVAL = (1 << 12) - 1;
+
+// Subtrees per worker below which the tree is split one level deeper.
+const int SUBTREES_PER_WORKER = 16;
+
+/* Precomputed optimistic bounds of a single position. For every suffix s of
+   the (efficiency sorted) player vector and every amount k of open slots,
+   reduced[l][s][k] holds the sum of the k largest values points - lambda_l *
+   price among players s.., and cheapest[s][k] the sum of the k lowest prices.
+   Sums over more players than the suffix contains are INFEASIBLE (negated for
+   reduced values). */
+struct Position_bounds {
+  vector<vector<vector<double>>> reduced;
+  vector<vector<double>> cheapest;
+};
 
-  ifstream in;
-  in.open(query);
-  in >> query_constraints.def >> query_constraints.mig >>
-      query_constraints.dav >> query_constraints.total_limit >>
-      query_constraints.player_limit;
-  in.close();
+/* Lagrangian relaxation of the budget constraint. For any multiplier lambda >=
+   0 the optimal completion of a partial lineup with remaining budget R scores
+   at most lambda * R plus, for every position, the k best reduced values
+   points - lambda * price of its open slots. Lambda = 0 is the plain top-k
+   points bound, and the minimum over lambda is the LP relaxation of the
+   per-position cardinality knapsack. A few multipliers around the root
+   optimum are kept so that every node bound is a handful of table lookups. */
+struct Search_bounds {
+  vector<double> multipliers;
+  array<Position_bounds, N_POSITIONS> positions;
+
+  // Contributions of the still empty positions after each search position.
+  vector<array<double, N_POSITIONS>> later_reduced;
+  array<double, N_POSITIONS> later_cheapest;
+};
 
-  return query_constraints;
+// Given a solution prints itself and its timing in the required format.
+void write_solution(const Partial_solution &feasible_solution) {
+  solution_writer.publish(
+      {feasible_solution.players, feasible_solution.current_points,
+       feasible_solution.current_price, feasible_solution.time});
 }
 
-// Initialises the used players data structure.
-Used_players initialise_used_players(const Player_database &database) {
-  Used_players used;
-
-  used.defenses = vector<bool>(database.defenses.size(), false);
-  used.migcampistes = vector<bool>(database.migcampistes.size(), false);
-  used.davanters = vector<bool>(database.davanters.size(), false);
-  used.porters = vector<bool>(database.porters.size(), false);
-
-  return used;
+// Checks whether the query constraints are satisfied.
+bool satisfies_query_constraints(const Query &query_constraints,
+                                 const Partial_solution &feasible_solution) {
+  return feasible_solution.counts == query_constraints.slots and
+         feasible_solution.current_price <= query_constraints.total_limit and
+         feasible_solution.current_points > best_points;
 }
 
-/* Auxiliar printing function. Given a position prints all the players from the
-   solution that belong to it, in the correct format. */
-void aux_write_solution(ofstream &out,
-                        unordered_map<string, vector<string>> &players_position,
-                        const string &position) {
-  bool first = true;
-  for (const string &name : players_position[position]) {
-    if (!first) {
-      out << ";" << name;
-    } else {
-      out << name;
-      first = false;
+/* For every suffix s of values and every k <= slots, returns the sum of the k
+   largest values of the suffix, or -INFEASIBLE if it has fewer than k. */
+vector<vector<double>> suffix_largest_sums(const vector<double> &values,
+                                           int slots) {
+  int n = values.size();
+  vector<vector<double>> sums(n + 1, vector<double>(slots + 1, -INFEASIBLE));
+  vector<double> largest;
+  for (int s = n; s >= 0; --s) {
+    if (s < n) {
+      largest.insert(upper_bound(largest.begin(), largest.end(), values[s],
+                                 greater<double>()),
+                     values[s]);
+      if (int(largest.size()) > slots)
+        largest.pop_back();
     }
+    sums[s][0] = 0;
+    for (int k = 1; k <= int(largest.size()); ++k)
+      sums[s][k] = sums[s][k - 1] + largest[k - 1];
   }
-  out << endl;
+  return sums;
 }
 
-// Given a solution prints itself and its timing in the required format.
-void write_solution(Partial_solution feasible_solution) {
-  ofstream out(output_file);
-  out.setf(ios::fixed);
-  out.precision(1);
-
-  out << feasible_solution.time << endl;
+// Precomputes the bound tables of every position for the given query.
+Search_bounds compute_bounds(const Player_database &database,
+                             const Query &query_constraints) {
+  Search_bounds bounds;
+  double lambda = root_multiplier(database, query_constraints);
+  bounds.multipliers = {0.0, 0.5 * lambda, lambda, 1.5 * lambda,
+                        2.0 * lambda};
+
+  int n_multipliers = bounds.multipliers.size();
+  for (Position position : POSITIONS) {
+    const Position_players &players = database[position];
+    int slots = query_constraints.slots[position];
+    Position_bounds &position_bounds = bounds.positions[position];
+
+    for (double multiplier : bounds.multipliers) {
+      vector<double> values;
+      for (int i = 0; i < players.size(); ++i)
+        values.push_back(
+            max(0.0, players.points[i] - multiplier * players.price[i]));
+      position_bounds.reduced.push_back(suffix_largest_sums(values, slots));
+    }
 
-  // Creates a map to group soccer players by position and fills the map.
-  unordered_map<string, vector<string>> players_position;
-  for (const Player &player : feasible_solution.players) {
-    players_position[player.position].push_back(player.name);
+    vector<double> negated_prices;
+    for (int i = 0; i < players.size(); ++i)
+      negated_prices.push_back(-players.price[i]);
+    position_bounds.cheapest = suffix_largest_sums(negated_prices, slots);
+    for (vector<double> &sums : position_bounds.cheapest)
+      for (double &sum : sums)
+        sum = -sum;
   }
 
-  out << "POR: ";
-  aux_write_solution(out, players_position, "por");
-  out << "DEF: ";
-  aux_write_solution(out, players_position, "def");
-  out << "MIG: ";
-  aux_write_solution(out, players_position, "mig");
-  out << "DAV: ";
-  aux_write_solution(out, players_position, "dav");
-
-  out << "Punts: " << feasible_solution.best_points << endl;
-  out << "Preu: " << feasible_solution.current_price << endl;
-
-  out.close();
-}
-
-// Checks whether the query constraints are satisfied.
-bool satisfies_query_constraints(const Query &query_constraints,
-                                 const Partial_solution &feasible_solution) {
-  return feasible_solution.def_count == query_constraints.def and
-         feasible_solution.mig_count == query_constraints.mig and
-         feasible_solution.dav_count == query_constraints.dav and
-         feasible_solution.por_count == 1 and
-         feasible_solution.current_price <= query_constraints.total_limit and
-         feasible_solution.current_points > feasible_solution.best_points;
-}
-
-// References the appropriate player vector based on player position.
-vector<Player> get_players(const Player_database &database, string position) {
-  if (position == "def")
-    return database.defenses;
-  else if (position == "mig")
-    return database.migcampistes;
-  else if (position == "dav")
-    return database.davanters;
-  else if (position == "por")
-    return database.porters;
-
-  vector<Player> aux;
-  return aux;
+  bounds.later_reduced.assign(n_multipliers, {});
+  bounds.later_cheapest = {};
+  for (int idx = N_POSITIONS - 2; idx >= 0; --idx) {
+    int slots = query_constraints.slots[idx + 1];
+    for (int l = 0; l < n_multipliers; ++l)
+      bounds.later_reduced[l][idx] =
+          bounds.later_reduced[l][idx + 1] +
+          bounds.positions[idx + 1].reduced[l][0][slots];
+    bounds.later_cheapest[idx] = bounds.later_cheapest[idx + 1] +
+                                 bounds.positions[idx + 1].cheapest[0][slots];
+  }
+  return bounds;
 }
 
-// References the appropriate player amount based on player position.
-int &get_count(Partial_solution &feasible_solution, string position) {
-  if (position == "def")
-    return feasible_solution.def_count;
-  else if (position == "mig")
-    return feasible_solution.mig_count;
-  else if (position == "dav")
-    return feasible_solution.dav_count;
-  else if (position == "por")
-    return feasible_solution.por_count;
-
-  static int aux;
-  return aux;
+/* Upper bound on the points that can still be added when 'open' slots of the
+   position idx are filled from players first.. and the positions after idx
+   are filled completely, with the given remaining budget. Returns
+   -INFEASIBLE when not even the cheapest completion fits in the budget. */
+double optimistic_bound(const Search_bounds &bounds, int idx, int first,
+                        int open, int remaining_budget) {
+  const Position_bounds &position_bounds = bounds.positions[idx];
+  if (position_bounds.cheapest[first][open] + bounds.later_cheapest[idx] >
+      remaining_budget)
+    return -INFEASIBLE;
+
+  double bound = INFEASIBLE;
+  for (int l = 0; l < int(bounds.multipliers.size()); ++l)
+    bound = min(bound, bounds.multipliers[l] * remaining_budget +
+                           position_bounds.reduced[l][first][open] +
+                           bounds.later_reduced[l][idx]);
+  return bound;
 }
 
-// References the appropriate query constraint based on player position.
-int get_query_constraint(const Query &query_constraints, string position) {
-  if (position == "def")
-    return query_constraints.def;
-  else if (position == "mig")
-    return query_constraints.mig;
-  else if (position == "dav")
-    return query_constraints.dav;
-  else if (position == "por")
-    return query_constraints.por;
-
-  return 0;
+// Checks, every few nodes, whether the deadline has been reached.
+bool deadline_reached(long long visited_nodes) {
+  if (not timed_out and (visited_nodes & CLOCK_INTERVAL) == 0 and
+      now() > deadline)
+    timed_out = true;
+  return timed_out;
 }
 
-/* References the appropriate boolean vector indicating used players based on
-   player position. */
-vector<bool> &get_used_players(Used_players &used, string position) {
-  if (position == "def")
-    return used.defenses;
-  else if (position == "mig")
-    return used.migcampistes;
-  else if (position == "dav")
-    return used.davanters;
-  else if (position == "por")
-    return used.porters;
-
-  static vector<bool> aux;
-  return aux;
+// Accounts for the bound of a node left open by the deadline.
+void record_open_bound(int current_points, double bound) {
+  if (bound == -INFEASIBLE)
+    return;
+  lock_guard<mutex> guard(incumbent_lock);
+  open_bound = max(open_bound, current_points + int(floor(bound + 1e-6)));
 }
 
+/* Extends the partial solution slot by slot. Players of the same position are
+   picked in increasing index order (each slot starts right after the previous
+   pick of its position, given by 'first'), so every subset of a position is
+   generated exactly once instead of once per permutation. When 'subtrees' is
+   given, partial solutions with 'split_depth' players are collected as roots
+   of independent subtrees instead of being extended. */
 void backtracking(const Player_database &database,
-                  const Query &query_constraints, Used_players &used,
-                  Partial_solution &feasible_solution,
-                  const vector<string> &positions, int idx) {
+                  const Query &query_constraints, const Search_bounds &bounds,
+                  Partial_solution &feasible_solution, int idx, int first,
+                  vector<Subtree> *subtrees = nullptr, int split_depth = 0) {
+  ++feasible_solution.visited_nodes;
+
   /* Base case: a partial solution has been extended to a feasible solution and
      can be considered as a final problem solution. The following condition
      checks whether current solution satisfies the query constraints, and
      updates the best solution found till now. */
   if (satisfies_query_constraints(query_constraints, feasible_solution)) {
 
-    // Updates feasible solution atributes and writes it.
-    end_time = now();
-    feasible_solution.time = end_time - start_time;
-    feasible_solution.best_points = feasible_solution.current_points;
-    write_solution(feasible_solution);
+    /* Updates feasible solution atributes and writes it, unless another
+       worker got a better one meanwhile. */
+    lock_guard<mutex> guard(incumbent_lock);
+    if (feasible_solution.current_points > best_points) {
+      end_time = now();
+      feasible_solution.time = end_time - start_time;
+      best_points = feasible_solution.current_points;
+      write_solution(feasible_solution);
+    }
     return;
   }
 
@@ -313,55 +273,485 @@ void backtracking(const Player_database &database,
   /* Recursive case:
      Extends the partial solution including a soccer player whether satisfies
      the query constraints. */
-  string position = positions[idx];
-  const vector<Player> &players = get_players(database, position);
+  Position position = POSITIONS[idx];
+  const Position_players &players = database[position];
+
+  int open = query_constraints.slots[position] -
+             feasible_solution.counts[position];
+  int remaining_budget =
+      query_constraints.total_limit - feasible_solution.current_price;
+
+  // Deadline: the whole subtree is left open.
+  if (deadline_reached(feasible_solution.visited_nodes)) {
+    record_open_bound(
+        feasible_solution.current_points,
+        optimistic_bound(bounds, idx, first, open, remaining_budget));
+    return;
+  }
 
-  if (get_count(feasible_solution, position) <
-      get_query_constraint(query_constraints, position)) {
-    for (int i = 0; i < int(players.size()); ++i) {
+  // Subtree collection.
+  if (subtrees != nullptr and
+      int(feasible_solution.players.size()) == split_depth) {
+    Subtree subtree = {{}, split_depth, idx, first};
+    copy(feasible_solution.players.begin(), feasible_solution.players.end(),
+         subtree.prefix.begin());
+    subtrees->push_back(subtree);
+    return;
+  }
+
+  if (open > 0) {
+    for (int i = first; i < players.size(); ++i) {
+
+      /* Bounding condition: the remaining slots are filled from players i..
+         at best, and that bound only decreases as i grows, so once it cannot
+         beat the best solution found no later player can either. */
+      double bound = optimistic_bound(bounds, idx, i, open, remaining_budget);
+      if (feasible_solution.current_points + floor(bound + 1e-6) <= best_points)
+        break;
+
+      // Deadline: players i.. are left open while unwinding.
+      if (timed_out) {
+        record_open_bound(feasible_solution.current_points, bound);
+        break;
+      }
 
       /* Pruning condition: checks whether adding the player exceeds the
          remaining budget. */
-      if (feasible_solution.current_price + players[i].price <=
-              query_constraints.total_limit and
-          not get_used_players(used, position)[i]) {
+      if (feasible_solution.current_price + players.price[i] <=
+          query_constraints.total_limit) {
 
         // Updates soccer player position counter, price, and points.
-        feasible_solution.players.push_back(players[i]);
-        get_used_players(used, position)[i] = true;
-        get_count(feasible_solution, position)++;
-        feasible_solution.current_price += players[i].price;
-        feasible_solution.current_points += players[i].points;
+        feasible_solution.players.push_back({position, i});
+        feasible_solution.counts[position]++;
+        feasible_solution.current_price += players.price[i];
+        feasible_solution.current_points += players.points[i];
 
-        backtracking(database, query_constraints, used, feasible_solution,
-                     positions, idx);
+        // The next slot of this position only considers later players.
+        backtracking(database, query_constraints, bounds, feasible_solution,
+                     idx, i + 1, subtrees, split_depth);
 
         // Undo changes made during the recursive call.
-        feasible_solution.current_price -= players[i].price;
-        feasible_solution.current_points -= players[i].points;
-        get_count(feasible_solution, position)--;
-        get_used_players(used, position)[i] = false;
+        feasible_solution.current_price -= players.price[i];
+        feasible_solution.current_points -= players.points[i];
+        feasible_solution.counts[position]--;
         feasible_solution.players.pop_back();
       }
     }
   }
 
-  // Recursive call to the next player.
-  else if (idx + 1 < int(positions.size())) {
-    backtracking(database, query_constraints, used, feasible_solution,
-                 positions, idx + 1);
+  // Recursive call to the next position, starting from its first player.
+  else if (idx + 1 < N_POSITIONS) {
+    backtracking(database, query_constraints, bounds, feasible_solution,
+                 idx + 1, 0, subtrees, split_depth);
   }
 }
 
-// Main algorithm concerning exhaustive search and backtracking.
+// Takes the next subtree of the worker, stealing one when it has run out.
+bool next_subtree(vector<Worker_queue> &queues, int worker, Subtree &subtree) {
+  {
+    lock_guard<mutex> guard(queues[worker].lock);
+    if (not queues[worker].subtrees.empty()) {
+      subtree = move(queues[worker].subtrees.front());
+      queues[worker].subtrees.pop_front();
+      return true;
+    }
+  }
+  int n_workers = queues.size();
+  for (int offset = 1; offset < n_workers; ++offset) {
+    Worker_queue &victim = queues[(worker + offset) % n_workers];
+    lock_guard<mutex> guard(victim.lock);
+    if (not victim.subtrees.empty()) {
+      subtree = move(victim.subtrees.back());
+      victim.subtrees.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+// Adds a player to a partial solution.
+void add_player(const Player_database &database, const Lineup_player &player,
+                Partial_solution &feasible_solution) {
+  const Position_players &players = database[player.position];
+  feasible_solution.players.push_back(player);
+  feasible_solution.counts[player.position]++;
+  feasible_solution.current_price += players.price[player.index];
+  feasible_solution.current_points += players.points[player.index];
+}
+
+/* Partial solution at the root of a subtree, continuing the node count of
+   the worker. */
+Partial_solution subtree_root(const Player_database &database,
+                              const Subtree &subtree,
+                              long long visited_nodes) {
+  Partial_solution feasible_solution;
+  feasible_solution.visited_nodes = visited_nodes;
+  for (int k = 0; k < subtree.size; ++k)
+    add_player(database, subtree.prefix[k], feasible_solution);
+  return feasible_solution;
+}
+
+/* Main algorithm concerning exhaustive search and backtracking. The tree is
+   split into one subtree per goalkeeper, or per goalkeeper and first
+   defender when there are too few goalkeepers to keep every worker busy,
+   which are dealt round-robin to the workers so that each one starts with
+   promising subtrees, and balanced afterwards through work stealing. */
 void exhaustive_search(const Player_database &database,
-                       const Query &query_constraints, Used_players &used,
+                       const Query &query_constraints, int n_threads) {
+  Search_bounds bounds = compute_bounds(database, query_constraints);
+
+  int split_depth =
+      database[POR].size() >= SUBTREES_PER_WORKER * n_threads ? 1 : 2;
+  vector<Subtree> subtrees;
+  Partial_solution root;
+  backtracking(database, query_constraints, bounds, root, 0, 0, &subtrees,
+               split_depth);
+
+  vector<Worker_queue> queues(n_threads);
+  for (int i = 0; i < int(subtrees.size()); ++i)
+    queues[i % n_threads].subtrees.push_back(move(subtrees[i]));
+
+  vector<long long> visited_nodes(n_threads, 0);
+  auto worker = [&](int id) {
+    Subtree subtree;
+    while (next_subtree(queues, id, subtree)) {
+      Partial_solution prefix =
+          subtree_root(database, subtree, visited_nodes[id]);
+      backtracking(database, query_constraints, bounds, prefix, subtree.idx,
+                   subtree.first);
+      visited_nodes[id] = prefix.visited_nodes;
+    }
+  };
+
+  vector<thread> workers;
+  for (int id = 1; id < n_threads; ++id)
+    workers.emplace_back(worker, id);
+  worker(0);
+  for (thread &t : workers)
+    t.join();
+
+  // Search statistics.
+  long long total_nodes = root.visited_nodes;
+  for (long long nodes : visited_nodes)
+    total_nodes += nodes;
+  cerr << "Nodes: " << total_nodes << endl;
+
+  /* Optimality certificate, or the gap left by the deadline: the bound of
+     the nodes left open, capped by the root bound, is also written next to
+     the points of the lineup. Lineups are only written once they score, so
+     best_points is still 0 when none was. */
+  if (not timed_out and best_points == 0) {
+    cerr << "No lineup satisfies the query constraints." << endl;
+  } else if (not timed_out) {
+    cerr << "Optimality proven." << endl;
+    solution_writer.certify(best_points);
+  } else {
+    int bound = max(open_bound, int(best_points));
+    int root_bound = points_bound(database, query_constraints);
+    if (root_bound != NO_BOUND)
+      bound = min(bound, root_bound);
+    cerr << "Deadline reached, optimality not proven. Bound: " << bound
+         << ", gap: " << bound - best_points << endl;
+    if (best_points > 0)
+      solution_writer.certify(bound);
+  }
+}
+
+/* Merges two Pareto frontiers into the Pareto frontier of their union. On
+   equal prices the entry with more points comes first and hides the other. */
+Frontier pareto_merge(const Frontier &a, const Frontier &b) {
+  Frontier merged;
+  int i = 0, j = 0;
+  while (i < int(a.size()) or j < int(b.size())) {
+    bool take_a = j == int(b.size()) or
+                  (i < int(a.size()) and
+                   (a[i].price < b[j].price or
+                    (a[i].price == b[j].price and a[i].points >= b[j].points)));
+    const Frontier_entry &entry = take_a ? a[i++] : b[j++];
+    if (merged.empty() or entry.points > merged.back().points)
+      merged.push_back(entry);
+  }
+  return merged;
+}
+
+/* Drops the picks no frontier entry leads to any more, renumbering the rest.
+   Every pick comes after the one it links to, so a single forward pass
+   keeps the links valid. */
+void compact_picks(vector<Frontier> &layers, vector<Pick> &picks) {
+  vector<int> renumbered(picks.size(), -1);
+  for (const Frontier &layer : layers)
+    for (const Frontier_entry &entry : layer)
+      for (int pick = entry.left; pick != -1 and renumbered[pick] == -1;
+           pick = picks[pick].previous)
+        renumbered[pick] = 0;
+
+  vector<Pick> kept;
+  for (int pick = 0; pick < int(picks.size()); ++pick) {
+    if (renumbered[pick] == -1)
+      continue;
+    int previous = picks[pick].previous;
+    renumbered[pick] = kept.size();
+    kept.push_back({picks[pick].player,
+                    previous == -1 ? -1 : renumbered[previous]});
+  }
+  for (Frontier &layer : layers)
+    for (Frontier_entry &entry : layer)
+      if (entry.left != -1)
+        entry.left = renumbered[entry.left];
+  picks = kept;
+}
+
+/* Pareto frontier of choosing exactly 'slots' players of a position within
+   the budget, built player by player (Nemhauser-Ullmann). Picks are only
+   recorded for the extended entries that survive the merge, and the ones
+   left behind by later merges are compacted away once they outnumber the
+   live ones, so memory stays bounded by the frontier sizes instead of the
+   amount of extensions. */
+Frontier position_frontier(const Position_players &players, int slots,
+                           int total_limit, vector<Pick> &picks) {
+  vector<Frontier> layers(slots + 1);
+  layers[0] = {{0, 0, -1, -1}};
+
+  for (int i = 0; i < players.size(); ++i) {
+    for (int k = min(slots, i + 1); k >= 1; --k) {
+      // Extended entries keep the pick they extend as 'right' until merged.
+      Frontier extended;
+      for (const Frontier_entry &entry : layers[k - 1]) {
+        if (entry.price + players.price[i] > total_limit)
+          break;
+        extended.push_back({entry.price + players.price[i],
+                            entry.points + players.points[i], -1,
+                            entry.left});
+      }
+      layers[k] = pareto_merge(layers[k], extended);
+      for (Frontier_entry &entry : layers[k]) {
+        if (entry.left == -1) {
+          picks.push_back({i, entry.right});
+          entry.left = int(picks.size()) - 1;
+          entry.right = -1;
+        }
+      }
+    }
+
+    // Picks reachable from the layers, at most their entries times k.
+    long long live = 0;
+    for (int k = 1; k <= slots; ++k)
+      live += (long long)layers[k].size() * k;
+    if ((long long)picks.size() > 2 * live + 1024)
+      compact_picks(layers, picks);
+  }
+  compact_picks(layers, picks);
+  return layers[slots];
+}
+
+/* Pareto frontier of every pair of entries of the two frontiers within the
+   budget. Each entry of 'a' walks 'b' by increasing price, and a heap over
+   those cursors yields the pairs by price, so only the frontier is stored. */
+Frontier combine_frontiers(const Frontier &a, const Frontier &b,
+                           int total_limit) {
+  // Cursor (price, -points, entry of a, entry of b): cheapest pair on top.
+  typedef tuple<int, int, int, int> Cursor;
+  priority_queue<Cursor, vector<Cursor>, greater<Cursor>> cursors;
+  if (not b.empty())
+    for (int i = 0; i < int(a.size()); ++i)
+      if (a[i].price + b[0].price <= total_limit)
+        cursors.push({a[i].price + b[0].price, -(a[i].points + b[0].points),
+                      i, 0});
+
+  Frontier combined;
+  while (not cursors.empty()) {
+    auto [price, negated_points, i, j] = cursors.top();
+    cursors.pop();
+    if (combined.empty() or -negated_points > combined.back().points)
+      combined.push_back({price, -negated_points, i, j});
+    if (j + 1 < int(b.size()) and a[i].price + b[j + 1].price <= total_limit)
+      cursors.push({a[i].price + b[j + 1].price,
+                    -(a[i].points + b[j + 1].points), i, j + 1});
+  }
+  return combined;
+}
+
+// Adds the players of a position frontier entry to the solution.
+void add_frontier_players(const Player_database &database, Position position,
+                          const vector<Pick> &picks,
+                          const Frontier_entry &entry,
+                          Partial_solution &feasible_solution) {
+  for (int pick = entry.left; pick != -1; pick = picks[pick].previous)
+    add_player(database, {position, picks[pick].player}, feasible_solution);
+}
+
+/* Main algorithm concerning meet in the middle. The lineup is split into the
+   POR+DEF and MIG+DAV halves, the Pareto frontier of each half is built from
+   the per-position frontiers, and a two-pointer sweep pairs every entry of the
+   first half with the most expensive (hence best) affordable entry of the
+   second. */
+void meet_in_the_middle(const Player_database &database,
+                        const Query &query_constraints) {
+  int total_limit = query_constraints.total_limit;
+
+  array<vector<Pick>, N_POSITIONS> picks;
+  array<Frontier, N_POSITIONS> frontiers;
+  for (Position position : POSITIONS)
+    frontiers[position] =
+        position_frontier(database[position], query_constraints.slots[position],
+                          total_limit, picks[position]);
+  Frontier first_half =
+      combine_frontiers(frontiers[POR], frontiers[DEF], total_limit);
+  Frontier second_half =
+      combine_frontiers(frontiers[MIG], frontiers[DAV], total_limit);
+
+  cerr << "Frontiers: por " << frontiers[POR].size() << " def "
+       << frontiers[DEF].size() << " mig " << frontiers[MIG].size() << " dav "
+       << frontiers[DAV].size() << ", halves " << first_half.size() << " "
+       << second_half.size() << endl;
+
+  // Two-pointer sweep: as the first half gets pricier, j only moves down.
+  int best_i = -1, best_j = -1;
+  int j = int(second_half.size()) - 1;
+  for (int i = 0; i < int(first_half.size()); ++i) {
+    while (j >= 0 and first_half[i].price + second_half[j].price > total_limit)
+      --j;
+    if (j < 0)
+      break;
+    if (best_i == -1 or
+        first_half[i].points + second_half[j].points >
+            first_half[best_i].points + second_half[best_j].points) {
+      best_i = i;
+      best_j = j;
+    }
+  }
+  if (best_i == -1) {
+    cerr << "No lineup satisfies the query constraints." << endl;
+    return;
+  }
+
+  // Recovers the players of the four positions.
+  Partial_solution feasible_solution;
+  const Frontier_entry &first = first_half[best_i];
+  const Frontier_entry &second = second_half[best_j];
+  add_frontier_players(database, POR, picks[POR], frontiers[POR][first.left],
+                       feasible_solution);
+  add_frontier_players(database, DEF, picks[DEF], frontiers[DEF][first.right],
+                       feasible_solution);
+  add_frontier_players(database, MIG, picks[MIG], frontiers[MIG][second.left],
+                       feasible_solution);
+  add_frontier_players(database, DAV, picks[DAV], frontiers[DAV][second.right],
+                       feasible_solution);
+
+  end_time = now();
+  feasible_solution.time = end_time - start_time;
+  write_solution(feasible_solution);
+  solution_writer.certify(feasible_solution.current_points);
+}
+
+/* Lineup built by greedy.cc with its exponent and portfolio settings (as
+   tuned in the configuration file), on a single thread. Returns false if the
+   query is infeasible. */
+bool greedy_warm_start(const Player_database &database,
+                       const Query &query_constraints,
+                       const Config &greedy_settings,
                        Partial_solution &feasible_solution) {
-  vector<string> positions = {"por", "def", "mig", "dav"};
+  Greedy_lineup lineup;
+  if (not configured_greedy(
+          database, query_constraints,
+          setting(greedy_settings, "exponent", GREEDY_EXPONENT),
+          setting(greedy_settings, "portfolio", 1.0) != 0, 1, lineup))
+    return false;
+  for (const Lineup_player &player : lineup.players)
+    add_player(database, player, feasible_solution);
+  return true;
+}
+
+/* Player of a warm start lineup, kept by its name while the candidates are
+   reduced. */
+struct Warm_player {
+  Position position;
+  int name;
+  int price;
+  int points;
+};
+
+/* Lineup of a solution file, as written by any of the solvers, after
+   checking it against the database and the query constraints. Returns false
+   if the file cannot be read or its lineup is not feasible. */
+bool file_warm_start(const Player_database &database,
+                     const Query &query_constraints,
+                     const string &solution_file,
+                     vector<Warm_player> &lineup) {
+  ifstream in(solution_file);
+  string line;
+  if (not getline(in, line))
+    return false;
+
+  array<int, N_POSITIONS> counts = {};
+  int price = 0;
+  vector<bool> used(database.names.size(), false);
+  for (Position position : POSITIONS) {
+    if (not getline(in, line) or
+        line.compare(0, POSITION_LABELS[position].size() + 2,
+                     POSITION_LABELS[position] + ": ") != 0)
+      return false;
+
+    istringstream names(line.substr(POSITION_LABELS[position].size() + 2));
+    string name;
+    while (getline(names, name, ';')) {
+      const Position_players &players = database[position];
+      int i = 0;
+      while (i < players.size() and
+             (database.names[players.name[i]] != name or
+              used[players.name[i]]))
+        ++i;
+      if (i == players.size())
+        return false;
+      used[players.name[i]] = true;
+      counts[position]++;
+      price += players.price[i];
+      lineup.push_back(
+          {position, players.name[i], players.price[i], players.points[i]});
+    }
+  }
+
+  return counts == query_constraints.slots and
+         price <= query_constraints.total_limit;
+}
 
-  // Start the backtracking with the first player.
-  backtracking(database, query_constraints, used, feasible_solution, positions,
-               0);
+/* Partial solution of a warm start lineup among the reduced candidates. A
+   player dropped as dominated is replaced by the best unused candidate of
+   its position with at least its points for at most its price, so the
+   lineup stays feasible and does not lose points. Returns false if there is
+   no such candidate. */
+bool resolve_warm_start(const Player_database &database,
+                        const vector<Warm_player> &lineup,
+                        Partial_solution &feasible_solution) {
+  vector<bool> used(database.names.size(), false);
+  vector<Warm_player> dropped;
+  for (const Warm_player &warm : lineup) {
+    const Position_players &players = database[warm.position];
+    int i = 0;
+    while (i < players.size() and players.name[i] != warm.name)
+      ++i;
+    if (i == players.size()) {
+      dropped.push_back(warm);
+      continue;
+    }
+    used[warm.name] = true;
+    add_player(database, {warm.position, i}, feasible_solution);
+  }
+
+  for (const Warm_player &warm : dropped) {
+    const Position_players &players = database[warm.position];
+    int best = -1;
+    for (int i = 0; i < players.size(); ++i)
+      if (not used[players.name[i]] and players.points[i] >= warm.points and
+          players.price[i] <= warm.price and
+          (best == -1 or players.points[i] > players.points[best]))
+        best = i;
+    if (best == -1)
+      return false;
+    used[players.name[best]] = true;
+    add_player(database, {warm.position, best}, feasible_solution);
+  }
+  return true;
 }
 
 int main(int argc, char **argv) {
@@ -372,14 +762,71 @@ int main(int argc, char **argv) {
   query = argv[2];
   output_file = argv[3];
 
+  // Optional arguments.
+  int n_threads = 1;
+  string mode = "bnb";
+  string warm_start;
+  string trace_file;
+  for (int i = 4; i + 1 < argc; i += 2) {
+    string option = argv[i];
+    if (option == "--threads")
+      n_threads = max(1, stoi(argv[i + 1]));
+    else if (option == "--mode")
+      mode = argv[i + 1];
+    else if (option == "--deadline")
+      deadline = now() + stod(argv[i + 1]) - DEADLINE_MARGIN;
+    else if (option == "--warm-start")
+      warm_start = argv[i + 1];
+    else if (option == "--trace")
+      trace_file = argv[i + 1];
+  }
+
   /* Firstly reads the query to store player limit. Allows us to filter them
      during the database reading process. */
   Query query_constraints = read_query(query);
   Player_database database = read_data_base(data_base, query_constraints);
-  Used_players used = initialise_used_players(database);
 
-  // Algorithm execution, solution writting, and timing.
+  /* A warm start solution file is read before the candidates are reduced,
+     as its players may be dropped. */
+  vector<Warm_player> warm_lineup;
+  bool warm_file = not warm_start.empty() and warm_start != "greedy";
+  if (warm_file and not file_warm_start(database, query_constraints,
+                                        warm_start, warm_lineup)) {
+    cerr << "Warm start: no feasible lineup in " << warm_start << endl;
+    warm_start.clear();
+  }
+
+  reduce_candidates(database, query_constraints);
+  solution_writer.start(output_file, database, trace_file);
   start_time = now();
-  Partial_solution feasible_solution;
-  exhaustive_search(database, query_constraints, used, feasible_solution);
+
+  /* Warm start: the lineup, either the greedy one or the one of a previous
+     solution file, is written first and the branch and bound prunes from
+     the first node with its points, only writing better lineups. */
+  if (not warm_start.empty()) {
+    Partial_solution warm_solution;
+    bool found =
+        warm_file
+            ? resolve_warm_start(database, warm_lineup, warm_solution)
+            : greedy_warm_start(database, query_constraints,
+                                solver_settings("greedy", argc, argv, 4),
+                                warm_solution);
+    if (found) {
+      end_time = now();
+      warm_solution.time = end_time - start_time;
+      best_points = warm_solution.current_points;
+      write_solution(warm_solution);
+      cerr << "Warm start: " << warm_solution.current_points << " points"
+           << endl;
+    } else {
+      cerr << "Warm start: no feasible lineup in " << warm_start << endl;
+    }
+  }
+
+  // Algorithm execution, solution writting, and timing.
+  if (mode == "mitm")
+    meet_in_the_middle(database, query_constraints);
+  else
+    exhaustive_search(database, query_constraints, n_threads);
+  solution_writer.stop();
 }
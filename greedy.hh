@@ -0,0 +1,302 @@
+// Greedy Construction shared by greedy.cc and the warm start of exh.cc.
+//
+// Players are taken in a single efficiency order, reserving the cheapest
+// completion of the open slots so that the budget is never exhausted early,
+// and the lineup is then upgraded with the budget left. A portfolio of
+// scoring variants runs over threads and keeps the best lineup.
+
+#ifndef GREEDY_HH
+#define GREEDY_HH
+
+#include "players.hh"
+
+#include <atomic>
+#include <thread>
+using namespace std;
+
+/* Default efficiency exponent: players are ordered by points / price^exponent.
+   By manually experimenting 0.35 has shown to be very effective, and the tune
+   tool can refine it in the configuration file. */
+const double GREEDY_EXPONENT = 0.35;
+
+/* Cheapest cost of filling 'open' slots of every position with players of
+   every suffix of the order: cost(i, position, open) only takes players from
+   order[i] onwards, and is UNFILLABLE when the suffix has too few of them.
+   Built backwards in a single pass, as a knapsack over the slot counts. */
+struct Suffix_costs {
+  array<int, N_POSITIONS> offset;
+  int row_size;
+  vector<long long> cost;
+
+  long long operator()(int i, Position position, int open) const {
+    return cost[i * row_size + offset[position] + open];
+  }
+};
+
+// Cost of the slots that no suffix of the order can fill.
+const long long UNFILLABLE = numeric_limits<long long>::max() / 4;
+
+inline Suffix_costs suffix_costs(const Player_database &database,
+                                 const Query &query_constraints,
+                                 const vector<Lineup_player> &order) {
+  Suffix_costs costs;
+  costs.row_size = 0;
+  for (Position position : POSITIONS) {
+    costs.offset[position] = costs.row_size;
+    costs.row_size += query_constraints.slots[position] + 1;
+  }
+
+  int n = order.size();
+  costs.cost.assign((n + 1) * costs.row_size, UNFILLABLE);
+  for (Position position : POSITIONS)
+    costs.cost[n * costs.row_size + costs.offset[position]] = 0;
+  for (int i = n - 1; i >= 0; --i) {
+    long long *row = &costs.cost[i * costs.row_size];
+    const long long *next = row + costs.row_size;
+    copy(next, next + costs.row_size, row);
+
+    const Lineup_player &player = order[i];
+    int price = database[player.position].price[player.index];
+    int first = costs.offset[player.position];
+    for (int open = 1; open <= query_constraints.slots[player.position];
+         ++open)
+      row[first + open] =
+          min(row[first + open], price + next[first + open - 1]);
+  }
+  return costs;
+}
+
+// Lineup built by the greedy.
+struct Greedy_lineup {
+  vector<Lineup_player> players;
+  int points = 0;
+  int price = 0;
+};
+
+/* Budget-fill pass: while some lineup player can be replaced by an unused
+   player of its position with more points within the budget left, applies
+   the upgrade gaining the most points (the cheapest among equals, then the
+   first slot). Every upgrade finds the best affordable replacement of each
+   slot through the price index, whose 'depth' best players per price
+   prefix always include an unused one. */
+inline void upgrade_lineup(const Player_database &database,
+                           const Query &query_constraints,
+                           const Price_indexes &indexes,
+                           Greedy_lineup &lineup) {
+  array<vector<bool>, N_POSITIONS> used;
+  for (Position position : POSITIONS)
+    used[position].assign(database[position].size(), false);
+  for (const Lineup_player &player : lineup.players)
+    used[player.position][player.index] = true;
+
+  while (true) {
+    int best_slot = -1, best_player = -1, best_gain = 0, best_cost = 0;
+    for (int slot = 0; slot < int(lineup.players.size()); ++slot) {
+      const Lineup_player &player = lineup.players[slot];
+      const Position_players &players = database[player.position];
+      const Price_index &index = indexes[player.position];
+      int affordable = index.affordable(query_constraints.total_limit -
+                                        lineup.price +
+                                        players.price[player.index]);
+      for (int r = 0; r < index.depth; ++r) {
+        int j = index.best(affordable, r);
+        if (j == -1 or used[player.position][j])
+          continue;
+        int gain = players.points[j] - players.points[player.index];
+        int cost = players.price[j] - players.price[player.index];
+        if (gain > best_gain or
+            (gain == best_gain and gain > 0 and cost < best_cost)) {
+          best_slot = slot;
+          best_player = j;
+          best_gain = gain;
+          best_cost = cost;
+        }
+        break;
+      }
+    }
+    if (best_slot == -1)
+      return;
+
+    Lineup_player &player = lineup.players[best_slot];
+    used[player.position][player.index] = false;
+    used[player.position][best_player] = true;
+    player.index = best_player;
+    lineup.points += best_gain;
+    lineup.price += best_cost;
+  }
+}
+
+/* Main algorithm concerning a greedy approach. Takes the players in a single
+   pass, ordered by defined criteria (efficiency ratio), as long as the
+   budget left still covers the cheapest way of filling the open slots with
+   the players after them. Either taking or skipping a player keeps that
+   reserve covered, so the pass never dead-ends: the query is infeasible
+   (and false is returned) exactly when the reserve of the whole order
+   exceeds the budget. The lineup is then upgraded with the budget left. */
+inline bool greedy_search(const Player_database &database,
+                          const Query &query_constraints,
+                          const Price_indexes &indexes,
+                          const vector<Lineup_player> &order,
+                          Greedy_lineup &lineup) {
+  Suffix_costs costs = suffix_costs(database, query_constraints, order);
+  array<int, N_POSITIONS> counts = {};
+
+  // Cheapest cost of the open slots with the players from order[i] onwards.
+  auto reserve = [&](int i) {
+    long long total = 0;
+    for (Position position : POSITIONS)
+      total += costs(i, position,
+                     query_constraints.slots[position] - counts[position]);
+    return total;
+  };
+
+  if (reserve(0) > query_constraints.total_limit)
+    return false;
+
+  for (int i = 0; i < int(order.size()); ++i) {
+    const Lineup_player &player = order[i];
+    const Position_players &players = database[player.position];
+    int open =
+        query_constraints.slots[player.position] - counts[player.position];
+    if (open == 0)
+      continue;
+
+    /* Takes the player if the budget left still covers the open slots,
+       including one less of its position. */
+    long long taken_reserve = reserve(i + 1) -
+                              costs(i + 1, player.position, open) +
+                              costs(i + 1, player.position, open - 1);
+    if (lineup.price + players.price[player.index] + taken_reserve >
+        query_constraints.total_limit)
+      continue;
+
+    // Adds the player to the team, and updates counters, prices, and points.
+    lineup.players.push_back(player);
+    counts[player.position]++;
+    lineup.price += players.price[player.index];
+    lineup.points += players.points[player.index];
+  }
+  upgrade_lineup(database, query_constraints, indexes, lineup);
+  return true;
+}
+
+/* Scoring functions of the portfolio variants. RATIO ranks the players by
+   points / price^parameter: 0 by points alone, 1 by points per unit of
+   price. MARGINAL is budget-aware: points - parameter * rate * price, where
+   rate is the points per unit of budget of the lineup of the best players,
+   so the price is charged at what the budget is worth for this query. */
+enum Scoring { RATIO, MARGINAL };
+
+struct Variant {
+  Scoring scoring;
+  double parameter;
+};
+
+// Weights of the price in the MARGINAL variants, relative to the rate.
+const vector<double> PRICE_WEIGHTS = {0.25, 0.5, 0.75, 1, 1.5, 2, 4};
+
+/* Variants of the portfolio: the given exponent first, the exponents from 0
+   to 1.5 in steps of 0.05, and the budget-aware scorings. */
+inline vector<Variant> portfolio_variants(double exponent) {
+  vector<Variant> variants = {{RATIO, exponent}};
+  for (int step = 0; step <= 30; ++step)
+    variants.push_back({RATIO, step * 0.05});
+  for (double weight : PRICE_WEIGHTS)
+    variants.push_back({MARGINAL, weight});
+  return variants;
+}
+
+// Order of all the players following the scoring of a variant.
+inline vector<Lineup_player> variant_order(const Player_database &database,
+                                           const Query &query_constraints,
+                                           const Variant &variant) {
+  if (variant.scoring == RATIO)
+    return efficiency_order(database, variant.parameter);
+
+  // Points per unit of budget of the lineup of the best players.
+  double best_points = 0;
+  for (Position position : POSITIONS) {
+    vector<int> points = database[position].points;
+    int slots = min(query_constraints.slots[position], int(points.size()));
+    partial_sort(points.begin(), points.begin() + slots, points.end(),
+                 greater<int>());
+    best_points += accumulate(points.begin(), points.begin() + slots, 0);
+  }
+  double weight =
+      variant.parameter * best_points / max(1, query_constraints.total_limit);
+
+  vector<pair<double, Lineup_player>> scored;
+  for (Position position : POSITIONS) {
+    const Position_players &players = database[position];
+    for (int i = 0; i < players.size(); ++i)
+      scored.push_back({players.points[i] - weight * players.price[i],
+                        {position, i}});
+  }
+  stable_sort(scored.begin(), scored.end(),
+              [](const pair<double, Lineup_player> &a,
+                 const pair<double, Lineup_player> &b) {
+                return a.first > b.first;
+              });
+  vector<Lineup_player> order;
+  for (const auto &[score, player] : scored)
+    order.push_back(player);
+  return order;
+}
+
+// Whether lineup a is better than b: more points, then cheaper.
+inline bool better_lineup(const Greedy_lineup &a, const Greedy_lineup &b) {
+  return a.points > b.points or (a.points == b.points and a.price < b.price);
+}
+
+/* Portfolio of greedy variants, run by 'n_threads' threads over the shared
+   database, each taking the next variant left. Returns the best lineup,
+   ties broken by the earliest variant so the result does not depend on the
+   threads, or false if the query is infeasible. */
+inline bool portfolio_search(const Player_database &database,
+                             const Query &query_constraints, double exponent,
+                             int n_threads, Greedy_lineup &best) {
+  Price_indexes indexes = build_price_indexes(database, query_constraints, 0);
+  vector<Variant> variants = portfolio_variants(exponent);
+  vector<Greedy_lineup> lineups(variants.size());
+  vector<char> feasible(variants.size(), false);
+  atomic<int> next(0);
+  auto run = [&]() {
+    for (int v = next++; v < int(variants.size()); v = next++)
+      feasible[v] = greedy_search(
+          database, query_constraints, indexes,
+          variant_order(database, query_constraints, variants[v]), lineups[v]);
+  };
+  vector<thread> threads;
+  for (int t = 1; t < n_threads; ++t)
+    threads.emplace_back(run);
+  run();
+  for (thread &t : threads)
+    t.join();
+
+  int winner = -1;
+  for (int v = 0; v < int(variants.size()); ++v)
+    if (feasible[v] and (winner == -1 or better_lineup(lineups[v],
+                                                       lineups[winner])))
+      winner = v;
+  if (winner == -1)
+    return false;
+  best = lineups[winner];
+  return true;
+}
+
+/* Lineup of greedy.cc: the portfolio of variants, or the given exponent
+   alone when the portfolio is off. Returns false if the query is
+   infeasible. */
+inline bool configured_greedy(const Player_database &database,
+                              const Query &query_constraints, double exponent,
+                              bool portfolio, int n_threads,
+                              Greedy_lineup &lineup) {
+  if (portfolio)
+    return portfolio_search(database, query_constraints, exponent, n_threads,
+                            lineup);
+  return greedy_search(database, query_constraints,
+                       build_price_indexes(database, query_constraints, 0),
+                       efficiency_order(database, exponent), lineup);
+}
+
+#endif
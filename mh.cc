@@ -28,422 +28,1205 @@ Output:
   following information: a double with only one decimal indicating the time
   needed to find the best solution, the name of: the goalkeeper, defenders,
   midfielders and strikers; poitns, and total tactic price. All these
-  information will be written in the output file with proper format.
+  information will be written in the output file with proper format, followed
+  by an upper bound on the points of any lineup (the LP relaxation of the
+  per-position cardinality knapsack) as "Cota:".
 
 Algorithms:
 
-  Metaheuristics using simulated annealing approach.
+  Metaheuristics using simulated annealing approach: a greedy start improved
+  by single and double player swaps, with a seeded xoshiro256** generator and
+  geometric, linear or adaptive cooling (temperatures in points) that reheats
+  when the search stagnates. Alternatively, tabu search over single swaps
+  with aspiration and a hashed memory of the visited lineups, GRASP with
+  restricted candidate lists, local search and path relinking, or a memetic
+  algorithm over bitset encoded lineups.
+
+Options:
+
+  --seed N, --time SECONDS, --engine annealing|tabu|grasp|memetic, --chains N
+  (independent chains on their own threads, sharing the best lineup),
+  --exponent E (efficiency points / price^E ranking the players of the
+  constructions), --config FILE, --trace FILE (every improvement of the best
+  lineup as time,points,price).
+  Annealing: --cooling geometric|linear|adaptive, --final_temperature T,
+  --stagnation MOVES, --stats FILE (CSV of the moves proposed, evaluated and
+  accepted, rejections and temperature of every chain per 100 ms window).
+  Tabu search: --tenure ITERATIONS.
+  GRASP: --alpha GREEDINESS, --elite SIZE.
+  Memetic: --population SIZE, --mutation PROBABILITY, --workers N (threads
+  breeding each generation).
+
+  Every option can also be set as "mh.option value" in the configuration file
+  (solvers.cfg by default), as written by the tune tool.
 ===============================================================================
 */
-#include <algorithm>
-#include <cassert>
-#include <ctime>
-#include <cmath>
-#include <numeric>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
-#include <string>
-#include <unordered_map>
-#include <vector>
+#include "config.hh"
+#include "players.hh"
+#include "solution_writer.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 using namespace std;
 
 // Declaration of output file.
 string output_file;
 
-// Definition of player data structure.
-struct Player {
-  string name;
-  string position;
-  int price;
-  string team;
-  int points;
-};
-
-// Definition of player database data structure.
-struct Player_database {
-  vector<Player> porters;
-  vector<Player> defenses;
-  vector<Player> migcampistes;
-  vector<Player> davanters;
-};
-
-// Definition and goalkeeper initialisation of query data structure.
-struct Query {
-  int def;
-  int mig;
-  int dav;
-  int por = 1;
-  int total_limit;
-  int player_limit;
-};
-
 // Definition and initialisation of partial solution data structure.
 struct Partial_solution {
   double time;
-  int def_count = 0;
-  int mig_count = 0;
-  int dav_count = 0;
-  int por_count = 0;
+  array<int, N_POSITIONS> counts = {};
   int current_price = 0;
   int current_points = 0;
   int best_points = 0;
-  vector<Player> players;
-  vector<int> indexes;
+  vector<Lineup_player> players;
 };
 
-// Definition of used players data structure.
-struct Used_players {
-  vector<bool> porters;
-  vector<bool> defenses;
-  vector<bool> migcampistes;
-  vector<bool> davanters;
-};
+// Definition of used players data structure, one flag per player.
+typedef array<vector<bool>, N_POSITIONS> Used_players;
 
 // Timing.
 double start_time, end_time;
-double now() { return clock() / double(CLOCKS_PER_SEC); }
 
-// Boltzmann distribution temperature hyperparameter.
-double temperature = 1e5;
+// Writes the improved lineups off the search threads.
+Solution_writer solution_writer;
 
-// Sorts the players having into account points / price ratio.
-bool compare_players_efficiency(const Player &a, const Player &b) {
-  // Whether both players have 0 points, order them based on price.
-  if (a.points == 0 and b.points == 0) {
-    return a.price < b.price;
-  }
+/* Best points among all the chains. It is read without locking to skip the
+   lineups that cannot be the best, and only updated (together with the
+   published lineup) under the lock. */
+atomic<int> best_points(0);
+mutex incumbent_lock;
 
-  // Whether one player has 0 points, it should be considered less efficient.
-  if (a.points == 0) return false;
-  else if (b.points == 0) return true;
-  else {
-    double efficiency_a = (a.points * 1.0) / (a.price * 1.0);
-    double efficiency_b = (b.points * 1.0) / (b.price * 1.0);
-    
-    return efficiency_a > efficiency_b;
-  }
+// Initialises the used players data structure.
+Used_players initialise_used_players(const Player_database &database) {
+  Used_players used;
+  for (Position position : POSITIONS)
+    used[position] = vector<bool>(database[position].size(), false);
+  return used;
 }
 
-// Sorts the players having into account its position by points in ascending
-// order.
-void sort_players_by_points(Player_database &data_base) {
-  sort(data_base.porters.begin(), data_base.porters.end(),
-       compare_players_efficiency);
-  sort(data_base.defenses.begin(), data_base.defenses.end(),
-       compare_players_efficiency);
-  sort(data_base.migcampistes.begin(), data_base.migcampistes.end(),
-       compare_players_efficiency);
-  sort(data_base.davanters.begin(), data_base.davanters.end(),
-       compare_players_efficiency);
+// Writes the best solution found by the algorithm till now in the output file.
+void write_solution(const Partial_solution &feasible_solution) {
+  solution_writer.publish(
+      {feasible_solution.players, feasible_solution.current_points,
+       feasible_solution.current_price, feasible_solution.time});
 }
 
-// Reads the soccer player database.
-Player_database read_data_base(string data_base, Query query_constraints) {
-  Player_database database;
-
-  ifstream in(data_base);
-  while (not in.eof()) {
-    Player player;
+/* Records the current lineup of a chain as its best one, and writes it if no
+   other chain has found a better one. */
+void update_best_solution(Partial_solution &feasible_solution) {
+  feasible_solution.best_points = feasible_solution.current_points;
+  if (feasible_solution.current_points <= best_points)
+    return;
+
+  lock_guard<mutex> guard(incumbent_lock);
+  if (feasible_solution.current_points > best_points) {
+    end_time = now();
+    feasible_solution.time = end_time - start_time;
+    best_points = feasible_solution.current_points;
+    write_solution(feasible_solution);
+  }
+}
 
-    // Reads raw soccer player data.
-    getline(in, player.name, ';');
-    if (player.name == "")
-      break;
-    getline(in, player.position, ';');
-    in >> player.price;
-    char aux;
-    in >> aux;
-    getline(in, player.team, ';');
-    in >> player.points;
-    string aux2;
-    getline(in, aux2);
-
-    // Stores players that satisfy price limit constraints in separate vectors
-    // based on their positions.
-    if (player.price <= query_constraints.player_limit) {
-      if (player.position == "por") {
-        database.porters.push_back(player);
-      } else if (player.position == "def") {
-        database.defenses.push_back(player);
-      } else if (player.position == "mig") {
-        database.migcampistes.push_back(player);
-      } else if (player.position == "dav") {
-        database.davanters.push_back(player);
-      }
+/* Fast pseudo-random generator (xoshiro256**), seeded through splitmix64 so
+   that every seed gives a well mixed independent stream. */
+struct Random {
+  array<uint64_t, 4> state;
+
+  explicit Random(uint64_t seed) {
+    for (uint64_t &word : state) {
+      seed += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      word = z ^ (z >> 31);
     }
   }
-  in.close();
 
-  sort_players_by_points(database);
+  uint64_t next() {
+    uint64_t result = rotate(state[1] * 5, 7) * 9;
+    uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotate(state[3], 45);
+    return result;
+  }
 
-  return database;
-}
+  // Uniform double in [0, 1).
+  double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+  // Uniform integer in [0, n).
+  int below(int n) { return (next() >> 32) * n >> 32; }
+
+  static uint64_t rotate(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+};
+
+// Search engines improving the start lineup, and annealing cooling schedules.
+enum Engine { ANNEALING, TABU, GRASP, MEMETIC };
+enum Cooling { GEOMETRIC, LINEAR, ADAPTIVE };
+
+/* Annealing hyperparameters. Temperatures are measured in points: a move
+   losing d points is accepted with probability exp(-d / temperature). */
+struct Annealing_parameters {
+  Cooling cooling = GEOMETRIC;
+  double final_temperature = 0.2;
+  long long stagnation = 200000;
+};
+
+/* Tabu search hyperparameters: iterations a removed player stays tabu, and
+   iterations without improving before the lineup is perturbed. */
+struct Tabu_parameters {
+  int tenure = 20;
+  long long stagnation = 2000;
+};
+
+/* GRASP hyperparameters: greediness of the restricted candidate lists (0 only
+   takes the most efficient candidates, 1 any feasible one) and size of the
+   elite pool path relinking draws its guides from. */
+struct Grasp_parameters {
+  double alpha = 0.3;
+  int elite_size = 10;
+};
 
-// Reads the given query, aka tactic configuration and price constraints.
-Query read_query(string query) {
-  Query query_constraints;
+/* Memetic hyperparameters: population size, probability of mutating an
+   offspring, and threads breeding every generation. */
+struct Memetic_parameters {
+  int population = 30;
+  double mutation = 0.2;
+  int workers = 1;
+};
 
-  ifstream in;
-  in.open(query);
-  in >> query_constraints.def >> query_constraints.mig >>
-      query_constraints.dav >> query_constraints.total_limit >>
-      query_constraints.player_limit;
-  in.close();
+// Engine, time limit and hyperparameters of the metaheuristic.
+struct Mh_parameters {
+  Engine engine = ANNEALING;
+  double time_limit = 9.5;
+  Annealing_parameters annealing;
+  Tabu_parameters tabu;
+  Grasp_parameters grasp;
+  Memetic_parameters memetic;
+};
 
-  return query_constraints;
+// Worsening moves accepted with this probability at the initial temperature.
+const double INITIAL_ACCEPTANCE = 0.5;
+
+// Probability of proposing the best affordable replacement of a player.
+const double JUMP_PROBABILITY = 0.1;
+
+// Probability of proposing two simultaneous swaps instead of one.
+const double DOUBLE_PROBABILITY = 0.5;
+
+// Moves between two clock readings (minus one), and adaptive cooling window.
+const long long CLOCK_INTERVAL = (1 << 8) - 1;
+const int ADAPTIVE_WINDOW = 1000;
+
+// Length of the windows of the annealing statistics, in seconds.
+const double STATS_WINDOW = 0.1;
+
+/* Annealing statistics of a window of time: the temperature at its end,
+   moves proposed and those that drew a replacement already in the lineup,
+   players of the drawn positions (candidates) and those that fitted in the
+   budget, evaluated moves by sign (non-worsening ones are always accepted),
+   worsening moves accepted, and reheats on stagnation. */
+struct Annealing_window {
+  double start = 0;
+  double end = 0;
+  double temperature = 0;
+  long long proposals = 0;
+  long long used_rejections = 0;
+  long long candidates = 0;
+  long long affordable = 0;
+  long long improving = 0;
+  long long worsening = 0;
+  long long worsening_accepted = 0;
+  int reheats = 0;
+};
+
+/* Statistics of an annealing chain, in windows of STATS_WINDOW seconds. They
+   are only gathered when a stats file is given. */
+struct Annealing_stats {
+  vector<Annealing_window> windows;
+  Annealing_window current;
+
+  // Closes the current window once it has lasted long enough, or if last.
+  void sample(double time, double temperature, bool last) {
+    if (time - current.start < STATS_WINDOW and not last)
+      return;
+    current.end = time;
+    current.temperature = temperature;
+    windows.push_back(current);
+    current = Annealing_window();
+    current.start = time;
+  }
+};
+
+/* Draws the replacement of a lineup player among the 'affordable' cheapest
+   players of its position, those that fit in the budget as found by a binary
+   search of the price index: with probability JUMP_PROBABILITY the one with
+   the most points, otherwise a uniformly random one. Returns -1 if the drawn
+   player is already in the lineup. */
+int draw_replacement(const Price_index &index, const vector<bool> &used,
+                     int affordable, Random &random) {
+  if (random.uniform() < JUMP_PROBABILITY) {
+    for (int r = 0; r < index.depth; ++r) {
+      int j = index.best(affordable, r);
+      if (j != -1 and not used[j])
+        return j;
+    }
+    return -1;
+  }
+  int j = index.order[random.below(affordable)];
+  return used[j] ? -1 : j;
 }
 
-// Initialises the used players data structure.
-Used_players initialise_used_players(const Player_database &database) {
-  Used_players used;
+// Replacement of the lineup player in a slot.
+struct Swap {
+  int slot;
+  int player;
+};
 
-  used.defenses = vector<bool>(database.defenses.size(), false);
-  used.migcampistes = vector<bool>(database.migcampistes.size(), false);
-  used.davanters = vector<bool>(database.davanters.size(), false);
-  used.porters = vector<bool>(database.porters.size(), false);
+/* Move of the annealing neighbourhood: one or two simultaneous swaps, of the
+   same or different positions, with their price and points deltas. */
+struct Move {
+  array<Swap, 2> swaps;
+  int size = 0;
+  int price = 0;
+  int points = 0;
+  int candidates = 0;
+  int affordable = 0;
+};
 
-  return used;
+/* Draws a move, a double swap with probability DOUBLE_PROBABILITY. The
+   second replacement is drawn within the budget left by the first one, so
+   every move fits in the budget before being scored, and a cheaper first
+   replacement can fund a better second one. Also counts the players of the
+   drawn positions (candidates) and those that fit in the budget. Returns
+   false if a drawn replacement is already in the lineup. */
+bool draw_move(const Player_database &database, const Query &query_constraints,
+               const Price_indexes &indexes, const Used_players &used,
+               const Partial_solution &feasible_solution, Random &random,
+               Move &move) {
+  int n = feasible_solution.players.size();
+  move.size = n > 1 and random.uniform() < DOUBLE_PROBABILITY ? 2 : 1;
+  move.price = move.points = move.candidates = move.affordable = 0;
+
+  int first_slot = random.below(n);
+  for (int k = 0; k < move.size; ++k) {
+    int slot = k == 0 ? first_slot : (first_slot + 1 + random.below(n - 1)) % n;
+    const Lineup_player &player = feasible_solution.players[slot];
+    const Position_players &players = database[player.position];
+    const Price_index &index = indexes[player.position];
+    int affordable = index.affordable(
+        query_constraints.total_limit - feasible_solution.current_price -
+        move.price + players.price[player.index]);
+    move.candidates += players.size();
+    move.affordable += affordable;
+    int j = draw_replacement(index, used[player.position], affordable, random);
+    if (j == -1 or (k == 1 and j == move.swaps[0].player and
+                    player.position ==
+                        feasible_solution.players[move.swaps[0].slot].position))
+      return false;
+    move.swaps[k] = {slot, j};
+    move.price += players.price[j] - players.price[player.index];
+    move.points += players.points[j] - players.points[player.index];
+  }
+  return true;
 }
 
-// Compares two soccer players based on their positions in lexicographical
-// order.
-bool compare_players_by_position(const Player &a, const Player &b) {
-  return a.position < b.position;
+// Applies the swaps of a move to the lineup.
+void apply_move(const Move &move, Used_players &used,
+                Partial_solution &feasible_solution) {
+  for (int k = 0; k < move.size; ++k) {
+    Lineup_player &player = feasible_solution.players[move.swaps[k].slot];
+    used[player.position][player.index] = false;
+    used[player.position][move.swaps[k].player] = true;
+    player.index = move.swaps[k].player;
+  }
+  feasible_solution.current_price += move.price;
+  feasible_solution.current_points += move.points;
 }
 
-// Auxiliar printing function. Given a position prints all the players from the
-// solution that belong to it, in the correct format.
-void aux_write_solution(ofstream &out,
-                        unordered_map<string, vector<string>> &players_position,
-                        const string &position) {
-  bool first = true;
-  for (const string &name : players_position[position]) {
-    if (!first) {
-      out << ";" << name;
-    } else {
-      out << name;
-      first = false;
+/* Initial temperature: the one at which an average worsening swap of the
+   given lineup is accepted with probability INITIAL_ACCEPTANCE. */
+double initial_temperature(const Player_database &database,
+                           const Query &query_constraints,
+                           const Price_indexes &indexes,
+                           const Used_players &used,
+                           const Partial_solution &feasible_solution,
+                           Random &random) {
+  double worsening = 0;
+  int samples = 0;
+  for (int attempt = 0; attempt < 10000 and samples < 1000; ++attempt) {
+    int slot = random.below(feasible_solution.players.size());
+    const Lineup_player &player = feasible_solution.players[slot];
+    const Position_players &players = database[player.position];
+    const Price_index &index = indexes[player.position];
+    int affordable =
+        index.affordable(query_constraints.total_limit -
+                         feasible_solution.current_price +
+                         players.price[player.index]);
+    int j = draw_replacement(index, used[player.position], affordable, random);
+    int delta = j == -1 ? 0 : players.points[j] - players.points[player.index];
+    if (delta < 0) {
+      worsening -= delta;
+      ++samples;
     }
   }
-  out << endl;
+  return samples == 0 ? 1.0 : worsening / samples / -log(INITIAL_ACCEPTANCE);
 }
 
-// Writes the best solution found by the algorithm till now in the output file.
-void write_solution(Partial_solution feasible_solution) {
-  ofstream out(output_file);
-  out.setf(ios::fixed);
-  out.precision(1);
+/* Simulated annealing over single and double swaps: random lineup players
+   are replaced by unused players of their positions that fit in the budget. The
+   temperature follows the cooling schedule along the time limit, and is
+   reheated (the schedule restarting over the remaining time) when the best
+   lineup has not improved for a while. */
+void simulated_annealing(const Player_database &database,
+                         const Query &query_constraints,
+                         const Price_indexes &indexes, Used_players &used,
+                         Partial_solution &feasible_solution,
+                         const Mh_parameters &parameters, Random &random,
+                         Annealing_stats *stats) {
+  const Annealing_parameters &annealing = parameters.annealing;
+  double initial = initial_temperature(database, query_constraints, indexes,
+                                       used, feasible_solution, random);
+  double final = min(annealing.final_temperature, initial);
+  double temperature = initial;
+
+  double end = start_time + parameters.time_limit;
+  double epoch_start = now();
+  long long last_improvement = 0;
+  int window_moves = 0, window_accepted = 0;
+  if (stats != nullptr)
+    stats->current.start = epoch_start;
+
+  for (long long move = 1;; ++move) {
+    // Cooling schedule, along the time left in the epoch.
+    if ((move & CLOCK_INTERVAL) == 0) {
+      double time = now();
+      if (stats != nullptr)
+        stats->sample(time, temperature, time >= end);
+      if (time >= end)
+        break;
+      double progress = (time - epoch_start) / (end - epoch_start);
+      if (annealing.cooling == GEOMETRIC)
+        temperature = initial * pow(final / initial, progress);
+      else if (annealing.cooling == LINEAR)
+        temperature = initial + (final - initial) * progress;
+
+      // Reheat on stagnation.
+      if (move - last_improvement > annealing.stagnation) {
+        epoch_start = time;
+        temperature = initial;
+        last_improvement = move;
+        if (stats != nullptr)
+          ++stats->current.reheats;
+      }
+    }
 
-  // Outputs the time for this solution.
-  out << feasible_solution.time << endl;
+    /* Adaptive cooling: steers the acceptance rate of worsening moves towards
+       a target decaying from INITIAL_ACCEPTANCE, as the geometric schedule
+       would at an average worsening move. */
+    if (annealing.cooling == ADAPTIVE and window_moves == ADAPTIVE_WINDOW) {
+      double progress = (now() - epoch_start) / (end - epoch_start);
+      double target = pow(INITIAL_ACCEPTANCE,
+                          pow(initial / final, max(0.0, min(1.0, progress))));
+      double rate = double(window_accepted) / window_moves;
+      temperature *= rate > target ? 0.9 : 1.0 / 0.9;
+      temperature = max(final, min(initial, temperature));
+      window_moves = window_accepted = 0;
+    }
 
-  unordered_map<string, vector<string>> players_position;
+    // Random move proposal, always within the budget.
+    Move proposal;
+    bool drawn = draw_move(database, query_constraints, indexes, used,
+                           feasible_solution, random, proposal);
+    if (stats != nullptr) {
+      Annealing_window &window = stats->current;
+      ++window.proposals;
+      window.used_rejections += not drawn;
+      window.candidates += proposal.candidates;
+      window.affordable += proposal.affordable;
+      if (drawn)
+        ++(proposal.points < 0 ? window.worsening : window.improving);
+    }
+    if (not drawn)
+      continue;
+
+    // Metropolis acceptance criteria.
+    if (proposal.points < 0) {
+      ++window_moves;
+      if (random.uniform() >= exp(proposal.points / temperature))
+        continue;
+      ++window_accepted;
+      if (stats != nullptr)
+        ++stats->current.worsening_accepted;
+    }
+    apply_move(proposal, used, feasible_solution);
 
-  // Fills the map.
-  for (const Player &player : feasible_solution.players) {
-    players_position[player.position].push_back(player.name);
+    if (feasible_solution.current_points > feasible_solution.best_points) {
+      update_best_solution(feasible_solution);
+      last_improvement = move;
+    }
   }
+}
 
-  // Writes the tactic soccer players by positions.
-  out << "POR: ";
-  aux_write_solution(out, players_position, "por");
-  out << "DEF: ";
-  aux_write_solution(out, players_position, "def");
-  out << "MIG: ";
-  aux_write_solution(out, players_position, "mig");
-  out << "DAV: ";
-  aux_write_solution(out, players_position, "dav");
-
-  // Writes best solution achieved points and price.
-  out << "Punts: " << feasible_solution.best_points << endl;
-  out << "Preu: " << feasible_solution.current_price << endl;
-  out << endl;
-  out.close();
+/* Randomises a start lineup through a walk of random swaps, taking every one
+   that fits in the budget regardless of its points. */
+void randomise_solution(const Player_database &database,
+                        const Query &query_constraints,
+                        const Price_indexes &indexes, Used_players &used,
+                        Partial_solution &feasible_solution, Random &random) {
+  int n = feasible_solution.players.size();
+  for (int attempt = 0, swaps = 0; attempt < 100 * n and swaps < 2 * n;
+       ++attempt) {
+    Lineup_player &player = feasible_solution.players[random.below(n)];
+    const Position_players &players = database[player.position];
+    const Price_index &index = indexes[player.position];
+    int slack = query_constraints.total_limit -
+                feasible_solution.current_price + players.price[player.index];
+    int j = index.order[random.below(index.affordable(slack))];
+    if (used[player.position][j])
+      continue;
+    int price = feasible_solution.current_price - players.price[player.index] +
+                players.price[j];
+
+    used[player.position][player.index] = false;
+    used[player.position][j] = true;
+    feasible_solution.current_points +=
+        players.points[j] - players.points[player.index];
+    feasible_solution.current_price = price;
+    player.index = j;
+    ++swaps;
+  }
 }
 
-// Checks whether the query constraints are satisfied.
-bool satisfies_query_constraints(const Query& query_constraints,
-                                 const Partial_solution &feasible_solution) {
-  return feasible_solution.def_count == query_constraints.def and
-         feasible_solution.mig_count == query_constraints.mig and
-         feasible_solution.dav_count == query_constraints.dav and
-         feasible_solution.por_count == 1 and
-         feasible_solution.current_price <= query_constraints.total_limit and
-         feasible_solution.current_points > feasible_solution.best_points;
+// Random moves without improving after which the GRASP local search stops.
+const int LOCAL_SEARCH_ATTEMPTS = 100;
+
+// Iterations between two clock readings of the tabu search (minus one).
+const long long TABU_CLOCK_INTERVAL = (1 << 4) - 1;
+
+// Visited lineups remembered by the tabu search before forgetting them all.
+const size_t TABU_MEMORY = 1 << 20;
+
+/* Tabu search over single swaps. Every iteration takes the best admissible
+   swap, even if it worsens the lineup: the replacement must fit in the
+   budget, must not have been removed in the last 'tenure' iterations, and
+   must not lead back to a lineup already visited, which is detected through
+   Zobrist hashing. Moves beating the best lineup of the chain are always
+   admissible (aspiration). Since the price index keeps enough best players
+   per prefix to skip the lineup and the tabu ones, the best replacement of
+   every player is found without scanning its position. */
+void tabu_search(const Player_database &database,
+                 const Query &query_constraints, const Price_indexes &indexes,
+                 Used_players &used, Partial_solution &feasible_solution,
+                 const Mh_parameters &parameters, Random &random) {
+  const Tabu_parameters &tabu = parameters.tabu;
+
+  // Zobrist keys of the players, and hash of the current lineup.
+  array<vector<uint64_t>, N_POSITIONS> keys;
+  array<vector<long long>, N_POSITIONS> tabu_until;
+  for (Position position : POSITIONS) {
+    for (int i = 0; i < database[position].size(); ++i)
+      keys[position].push_back(random.next());
+    tabu_until[position].assign(database[position].size(), 0);
+  }
+  auto lineup_hash = [&]() {
+    uint64_t hash = 0;
+    for (const Lineup_player &player : feasible_solution.players)
+      hash ^= keys[player.position][player.index];
+    return hash;
+  };
+  uint64_t hash = lineup_hash();
+  unordered_set<uint64_t> visited = {hash};
+
+  double end = start_time + parameters.time_limit;
+  long long last_improvement = 0;
+  for (long long iteration = 1;; ++iteration) {
+    if ((iteration & TABU_CLOCK_INTERVAL) == 0 and now() >= end)
+      break;
+
+    // Best admissible swap of every lineup player.
+    int best_slot = -1, best_j = -1, best_delta = 0;
+    for (int slot = 0; slot < int(feasible_solution.players.size()); ++slot) {
+      const Lineup_player &player = feasible_solution.players[slot];
+      Position position = player.position;
+      const Position_players &players = database[position];
+      const Price_index &index = indexes[position];
+      int affordable =
+          index.affordable(query_constraints.total_limit -
+                           feasible_solution.current_price +
+                           players.price[player.index]);
+
+      for (int r = 0; r < index.depth; ++r) {
+        int j = index.best(affordable, r);
+        if (j == -1)
+          break;
+        if (used[position][j])
+          continue;
+        int delta = players.points[j] - players.points[player.index];
+        bool aspiration = feasible_solution.current_points + delta >
+                          feasible_solution.best_points;
+        if (not aspiration and
+            (tabu_until[position][j] > iteration or
+             visited.count(hash ^ keys[position][player.index] ^
+                           keys[position][j])))
+          continue;
+        if (best_slot == -1 or delta > best_delta) {
+          best_slot = slot;
+          best_j = j;
+          best_delta = delta;
+        }
+        break;
+      }
+    }
+
+    // Every swap is tabu: forgets the tabu players and visited lineups.
+    if (best_slot == -1) {
+      for (Position position : POSITIONS)
+        fill(tabu_until[position].begin(), tabu_until[position].end(), 0);
+      visited = {hash};
+      continue;
+    }
+
+    // Applies the swap, making the removed player tabu.
+    Lineup_player &player = feasible_solution.players[best_slot];
+    Position position = player.position;
+    const Position_players &players = database[position];
+    tabu_until[position][player.index] = iteration + tabu.tenure;
+    hash ^= keys[position][player.index] ^ keys[position][best_j];
+    used[position][player.index] = false;
+    used[position][best_j] = true;
+    feasible_solution.current_price +=
+        players.price[best_j] - players.price[player.index];
+    feasible_solution.current_points += best_delta;
+    player.index = best_j;
+
+    if (visited.size() >= TABU_MEMORY)
+      visited.clear();
+    visited.insert(hash);
+
+    if (feasible_solution.current_points > feasible_solution.best_points) {
+      update_best_solution(feasible_solution);
+      last_improvement = iteration;
+    }
+
+    // Diversification: perturbs the lineup when the search stagnates.
+    if (iteration - last_improvement > tabu.stagnation) {
+      randomise_solution(database, query_constraints, indexes, used,
+                         feasible_solution, random);
+      hash = lineup_hash();
+      visited.insert(hash);
+      last_improvement = iteration;
+    }
+  }
 }
 
-// References the appropriate player vector based on player position.
-vector<Player> get_players(const Player_database& database, string position) {
-  if (position == "def")
-    return database.defenses;
-  else if (position == "mig")
-    return database.migcampistes;
-  else if (position == "dav")
-    return database.davanters;
-  else if (position == "por")
-    return database.porters;
-
-  vector<Player> aux;
-  return aux;
+// Lineup of the GRASP elite pool, with its players sorted.
+struct Elite_lineup {
+  vector<Lineup_player> players;
+  int points;
+  int price;
+};
+
+// Order of lineup players, by position and index.
+bool operator<(const Lineup_player &a, const Lineup_player &b) {
+  return make_pair(a.position, a.index) < make_pair(b.position, b.index);
+}
+bool operator==(const Lineup_player &a, const Lineup_player &b) {
+  return a.position == b.position and a.index == b.index;
 }
 
-// References the appropriate player amount based on player position.
-int &get_count(Partial_solution &feasible_solution, string position) {
-  if (position == "def")
-    return feasible_solution.def_count;
-  else if (position == "mig")
-    return feasible_solution.mig_count;
-  else if (position == "dav")
-    return feasible_solution.dav_count;
-  else if (position == "por")
-    return feasible_solution.por_count;
-
-  static int aux;
-  return aux;
+// Empties the lineup, releasing its players.
+void clear_solution(Used_players &used, Partial_solution &feasible_solution) {
+  for (const Lineup_player &player : feasible_solution.players)
+    used[player.position][player.index] = false;
+  feasible_solution.players.clear();
+  feasible_solution.counts = {};
+  feasible_solution.current_price = feasible_solution.current_points = 0;
 }
 
-// References the appropriate query constraint based on player position.
-int get_query_constraint(const Query &query_constraints, string position) {
-  if (position == "def")
-    return query_constraints.def;
-  else if (position == "mig")
-    return query_constraints.mig;
-  else if (position == "dav")
-    return query_constraints.dav;
-  else if (position == "por")
-    return query_constraints.por;
-
-  return 0;
+// Adds a player to the lineup.
+void add_player(const Player_database &database, const Lineup_player &player,
+                Used_players &used, Partial_solution &feasible_solution) {
+  const Position_players &players = database[player.position];
+  used[player.position][player.index] = true;
+  feasible_solution.players.push_back(player);
+  feasible_solution.counts[player.position]++;
+  feasible_solution.current_price += players.price[player.index];
+  feasible_solution.current_points += players.points[player.index];
 }
 
-vector<bool> &get_used_players(Used_players& used, string position) {
-  if (position == "def")
-    return used.defenses;
-  else if (position == "mig")
-    return used.migcampistes;
-  else if (position == "dav")
-    return used.davanters;
-  else if (position == "por")
-    return used.porters;
-
-  static vector<bool> aux;
-  return aux;
+/* Efficiency scores of the players of every position, ranking the candidates
+   of the constructions: points / price^exponent, or the points of the free
+   players. */
+typedef array<vector<double>, N_POSITIONS> Efficiency_scores;
+
+// Computes the efficiency scores once, instead of a pow() per candidate.
+Efficiency_scores efficiency_scores(const Player_database &database,
+                                    double exponent) {
+  Efficiency_scores scores;
+  for (Position position : POSITIONS) {
+    const Position_players &players = database[position];
+    for (int i = 0; i < players.size(); ++i)
+      scores[position].push_back(
+          players.price[i] > 0
+              ? players.points[i] / pow(players.price[i], exponent)
+              : players.points[i]);
+  }
+  return scores;
 }
 
-// Generates a feasible solution through a greedy algorithm, chosing first 11 players
-// that satisfy query constraints, ordered by points / price ratio.
-void construct_greedy_solution(const Player_database& database, const Query& query_constraints, 
-                               Used_players& used, Partial_solution& feasible_solution,
-                               const vector<string>& positions, int idx) {
-  while (not satisfies_query_constraints(query_constraints, feasible_solution)) {
-    string position = positions[idx];
-    const vector<Player> &players = get_players(database, position);
-
-    // Checks need for a particular player in terms of position.
-    if (get_count(feasible_solution, position) < get_query_constraint(query_constraints, position)) {
-      for (int i = 0; i < int(players.size()); ++i) {
-        if (get_count(feasible_solution, position) < get_query_constraint(query_constraints, position)) {
-          // Checks whether adding the player of a particular position exceeds the remaining budget.
-          if (feasible_solution.current_price + players[i].price <= query_constraints.total_limit) {
-            if (not get_used_players(used, position)[i]) {
-              // Updates soccer player position counter, price, and points.
-              feasible_solution.players.push_back(players[i]);
-              feasible_solution.indexes.push_back(i);
-              get_used_players(used, position)[i] = true;
-              get_count(feasible_solution, position)++;
-              feasible_solution.current_price += players[i].price;
-              feasible_solution.current_points += players[i].points;
-            }
-          }
+/* Builds a lineup from restricted candidate lists. Every step scores the
+   feasible candidates by efficiency and takes a random one among those
+   within alpha of the best score (relative to the score range). A candidate
+   is feasible if, once taken, the cheapest unused players of the open slots
+   still fit in the budget, so the construction never gets stuck. Returns
+   false if not even the cheapest lineup fits. */
+bool randomised_construction(const Player_database &database,
+                             const Query &query_constraints,
+                             const Price_indexes &indexes,
+                             const Efficiency_scores &efficiency,
+                             double alpha, Used_players &used,
+                             Partial_solution &feasible_solution,
+                             Random &random) {
+  clear_solution(used, feasible_solution);
+  int lineup_size = accumulate(query_constraints.slots.begin(),
+                               query_constraints.slots.end(), 0);
+
+  vector<Lineup_player> candidates;
+  vector<double> scores;
+  while (int(feasible_solution.players.size()) < lineup_size) {
+    /* Cheapest unused players of every open slot: cheapest[p][k] is the sum
+       of the k + 1 cheapest, and completion the cost of them all. */
+    array<vector<int>, N_POSITIONS> cheapest;
+    int completion = 0;
+    for (Position position : POSITIONS) {
+      int open = query_constraints.slots[position] -
+                 feasible_solution.counts[position];
+      const Price_index &index = indexes[position];
+      for (int k = 0, sum = 0; k < int(index.order.size()) and
+                               int(cheapest[position].size()) < open;
+           ++k) {
+        if (used[position][index.order[k]])
+          continue;
+        sum += index.price[k];
+        cheapest[position].push_back(sum);
+      }
+      if (int(cheapest[position].size()) < open)
+        return false;
+      if (open > 0)
+        completion += cheapest[position].back();
+    }
+
+    // Scores the feasible candidates.
+    candidates.clear();
+    scores.clear();
+    double best_score = 0, worst_score = 0;
+    for (Position position : POSITIONS) {
+      int open = query_constraints.slots[position] -
+                 feasible_solution.counts[position];
+      if (open == 0)
+        continue;
+      const Position_players &players = database[position];
+
+      /* Completion once the player is taken: if it is one of the 'open'
+         cheapest, the others of them, otherwise the open - 1 cheapest. */
+      int others = completion - cheapest[position][open - 1] +
+                   (open > 1 ? cheapest[position][open - 2] : 0);
+      for (int i = 0; i < players.size(); ++i) {
+        if (used[position][i])
+          continue;
+        if (feasible_solution.current_price + max(players.price[i] + others,
+                                                  completion) >
+            query_constraints.total_limit)
+          continue;
+        double score = efficiency[position][i];
+        if (candidates.empty()) {
+          best_score = worst_score = score;
+        } else {
+          best_score = max(best_score, score);
+          worst_score = min(worst_score, score);
         }
+        candidates.push_back({position, i});
+        scores.push_back(score);
       }
     }
-    
-    else if (idx + 1 < int(positions.size())) idx += 1;
+
+    if (candidates.empty())
+      return false;
+
+    // Random candidate of the restricted list.
+    double threshold = best_score - alpha * (best_score - worst_score);
+    int chosen = -1, seen = 0;
+    for (int c = 0; c < int(candidates.size()); ++c)
+      if (scores[c] >= threshold and random.below(++seen) == 0)
+        chosen = c;
+    add_player(database, candidates[chosen], used, feasible_solution);
   }
+  return true;
 }
 
-// Allows to worsen a partial solution with probability given by the Boltzmann distribution.
-bool probability(int new_points, int old_points) {
-  if (new_points == old_points or temperature == 0) return false;
-  double n = rand() / RAND_MAX, p = exp(- (old_points - new_points) / temperature);
-  if(n < p) return true;
-  return false;
+/* Local search: applies the best improving single swap until there is none,
+   then draws random moves (single or double swaps), going back to single
+   swaps after an improving one, until LOCAL_SEARCH_ATTEMPTS fail in a row. */
+void local_search(const Player_database &database,
+                  const Query &query_constraints, const Price_indexes &indexes,
+                  Used_players &used, Partial_solution &feasible_solution,
+                  Random &random) {
+  while (true) {
+    Move best;
+    for (int slot = 0; slot < int(feasible_solution.players.size()); ++slot) {
+      const Lineup_player &player = feasible_solution.players[slot];
+      const Position_players &players = database[player.position];
+      const Price_index &index = indexes[player.position];
+      int affordable =
+          index.affordable(query_constraints.total_limit -
+                           feasible_solution.current_price +
+                           players.price[player.index]);
+      for (int r = 0; r < index.depth; ++r) {
+        int j = index.best(affordable, r);
+        if (j == -1)
+          break;
+        if (used[player.position][j])
+          continue;
+        int delta = players.points[j] - players.points[player.index];
+        if (delta > best.points) {
+          best.swaps[0] = {slot, j};
+          best.size = 1;
+          best.price = players.price[j] - players.price[player.index];
+          best.points = delta;
+        }
+        break;
+      }
+    }
+    if (best.size > 0) {
+      apply_move(best, used, feasible_solution);
+      continue;
+    }
+
+    bool improved = false;
+    for (int attempt = 0; attempt < LOCAL_SEARCH_ATTEMPTS and not improved;
+         ++attempt) {
+      Move move;
+      if (draw_move(database, query_constraints, indexes, used,
+                    feasible_solution, random, move) and
+          move.points > 0) {
+        apply_move(move, used, feasible_solution);
+        improved = true;
+      }
+    }
+    if (not improved)
+      return;
+  }
 }
 
-// Sais whether a better solution has been found using simulated annealing.
-bool improve_solution(const Player_database& database, const Query& query_constraints, 
-                      Used_players& used, Partial_solution& feasible_solution) {
-  bool found = false;
-
-  // Generates a vector {0, 1, ..., n-1}.
-  vector<int> random(11);
-  iota(random.begin(), random.end(), 0);
-
-  // Shuffles the elements randomly.
-  random_shuffle(random.begin(), random.end());
-
-  for(int i = 0; i < 11 and not found; ++i) {
-    int idx = random[i];
-
-    // Choses one player from feasible solution at random to be changed.
-    Player& player = feasible_solution.players[idx];
-    string position = player.position;
-    int price = feasible_solution.current_price - player.price;
-    int points = feasible_solution.current_points - player.points;
-
-    const vector<Player> &players = get_players(database, position);
-
-    // Will try to change only one player and see if solution improves with simulated annealing approach.
-    for (int j = 0; j < int(players.size()) and not found; ++j) {
-      Player new_player = players[j];
-
-      // Seeks for points improvement allowed by query constraints.
-      if (not get_used_players(used, position)[j] and 
-         (new_player.price + price <= query_constraints.total_limit) and 
-         ((new_player.points + points > feasible_solution.current_points) or 
-          probability(new_player.points, player.points))) {
-        found = true;
-
-        // Updates feasible solution atributes with new player specs.
-        get_used_players(used, position)[feasible_solution.indexes[idx]] = false;
-        get_used_players(used, position)[j] = true;
-        feasible_solution.current_points = points + new_player.points;
-        feasible_solution.current_price = price + new_player.price;
-        feasible_solution.players[idx] = new_player;
-        feasible_solution.indexes[idx] = j;
-
-        if (feasible_solution.best_points < feasible_solution.current_points) {
-          // Updates feasible solution atributes.
-          end_time = now();
-          feasible_solution.time = end_time - start_time;
-          feasible_solution.best_points = feasible_solution.current_points;
-          write_solution(feasible_solution);
+/* Path relinking: walks from the lineup towards the guide. Every step swaps a
+   lineup player that the guide lacks for a guide player of the same position,
+   taking the one that scores the most points within the budget. The lineup
+   ends as the best one strictly between both ends, and false is returned if
+   there is none. */
+bool path_relinking(const Player_database &database,
+                    const Query &query_constraints, Used_players &used,
+                    Partial_solution &feasible_solution,
+                    const Elite_lineup &guide) {
+  Used_players in_guide = initialise_used_players(database);
+  for (const Lineup_player &player : guide.players)
+    in_guide[player.position][player.index] = true;
+
+  vector<Lineup_player> best_players;
+  int path_best_points = -1;
+  while (true) {
+    Move best;
+    int differences = 0;
+    for (int slot = 0; slot < int(feasible_solution.players.size()); ++slot) {
+      const Lineup_player &player = feasible_solution.players[slot];
+      if (in_guide[player.position][player.index])
+        continue;
+      ++differences;
+      const Position_players &players = database[player.position];
+      for (const Lineup_player &target : guide.players) {
+        if (target.position != player.position or
+            used[target.position][target.index])
+          continue;
+        int price = players.price[target.index] - players.price[player.index];
+        int points =
+            players.points[target.index] - players.points[player.index];
+        if (feasible_solution.current_price + price <=
+                query_constraints.total_limit and
+            (best.size == 0 or points > best.points)) {
+          best.swaps[0] = {slot, target.index};
+          best.size = 1;
+          best.price = price;
+          best.points = points;
         }
       }
     }
+    if (best.size == 0)
+      break;
 
-    // Updates temperature hyperparameter.
-    temperature *= 0.99999;
+    apply_move(best, used, feasible_solution);
+    if (differences > 1 and
+        feasible_solution.current_points > path_best_points) {
+      best_players = feasible_solution.players;
+      path_best_points = feasible_solution.current_points;
+    }
   }
 
-  return found;
+  if (path_best_points == -1)
+    return false;
+  clear_solution(used, feasible_solution);
+  for (const Lineup_player &player : best_players)
+    add_player(database, player, used, feasible_solution);
+  return true;
 }
 
-// Main algorithm concerning metaheursitics with GRASP approach.
-void grasp_mh(const Player_database& database,
-              const Query& query_constraints, Used_players& used,
-              Partial_solution& feasible_solution) {
-    // Defines player positions.
-    vector<string> positions = {"por", "def", "mig", "dav"};
+/* Adds a lineup to the elite pool, unless it is already in it or the pool is
+   full of better lineups, in which case the worst one is replaced. */
+void update_elite(vector<Elite_lineup> &elite, int elite_size,
+                  const Partial_solution &feasible_solution) {
+  Elite_lineup lineup = {feasible_solution.players,
+                         feasible_solution.current_points,
+                         feasible_solution.current_price};
+  sort(lineup.players.begin(), lineup.players.end());
+  for (const Elite_lineup &member : elite)
+    if (member.players == lineup.players)
+      return;
+
+  if (int(elite.size()) < elite_size) {
+    elite.push_back(lineup);
+    return;
+  }
+  auto worst = min_element(elite.begin(), elite.end(),
+                           [](const Elite_lineup &a, const Elite_lineup &b) {
+                             return a.points < b.points;
+                           });
+  if (worst != elite.end() and lineup.points > worst->points)
+    *worst = lineup;
+}
+
+/* GRASP: every iteration builds a lineup from restricted candidate lists,
+   improves it through local search, and relinks it with a random lineup of
+   the elite pool, improving the best lineup on the path as well. */
+void grasp_search(const Player_database &database,
+                  const Query &query_constraints, const Price_indexes &indexes,
+                  const Efficiency_scores &efficiency, Used_players &used,
+                  Partial_solution &feasible_solution,
+                  const Mh_parameters &parameters, Random &random) {
+  const Grasp_parameters &grasp = parameters.grasp;
+  vector<Elite_lineup> elite;
+  auto record = [&]() {
+    update_elite(elite, grasp.elite_size, feasible_solution);
+    if (feasible_solution.current_points > feasible_solution.best_points)
+      update_best_solution(feasible_solution);
+  };
+
+  local_search(database, query_constraints, indexes, used, feasible_solution,
+               random);
+  record();
+
+  double end = start_time + parameters.time_limit;
+  long long iterations = 0;
+  for (; now() < end; ++iterations) {
+    if (not randomised_construction(database, query_constraints, indexes,
+                                    efficiency, grasp.alpha, used,
+                                    feasible_solution, random))
+      break;
+    local_search(database, query_constraints, indexes, used,
+                 feasible_solution, random);
+    record();
+
+    Elite_lineup guide = elite[random.below(elite.size())];
+    if (path_relinking(database, query_constraints, used, feasible_solution,
+                       guide)) {
+      local_search(database, query_constraints, indexes, used,
+                   feasible_solution, random);
+      record();
+    }
+  }
+  cerr << "GRASP iterations: " << iterations << endl;
+}
 
-    // Constructs greedy partial solution.
-    construct_greedy_solution(database, query_constraints, used, feasible_solution, positions, 0);
-    feasible_solution.best_points = feasible_solution.current_points;
+/* Lineup of the memetic population, encoded as one bitset per position over
+   the (efficiency sorted) players of the position. */
+struct Genome {
+  array<vector<uint64_t>, N_POSITIONS> bits;
+  int points = 0;
+  int price = 0;
+};
 
-    // Applies simulated annealing.
-    while (improve_solution(database, query_constraints, used, feasible_solution));
+// Encodes a lineup as a genome.
+Genome encode(const Player_database &database,
+              const Partial_solution &feasible_solution) {
+  Genome genome;
+  for (Position position : POSITIONS)
+    genome.bits[position].assign((database[position].size() + 63) / 64, 0);
+  for (const Lineup_player &player : feasible_solution.players)
+    genome.bits[player.position][player.index / 64] |= 1ULL
+                                                        << (player.index % 64);
+  genome.points = feasible_solution.current_points;
+  genome.price = feasible_solution.current_price;
+  return genome;
+}
+
+// Players of a position whose bits are set.
+vector<int> set_players(const vector<uint64_t> &bits) {
+  vector<int> players;
+  for (int w = 0; w < int(bits.size()); ++w)
+    for (uint64_t word = bits[w]; word != 0; word &= word - 1)
+      players.push_back(64 * w + __builtin_ctzll(word));
+  return players;
+}
+
+/* Repairs a lineup over the budget: the least efficient player (by points /
+   price) that has a cheaper unused player in its position is replaced by the
+   most efficient of them, following the efficiency order of the positions,
+   until the lineup fits. Returns false if no player can get cheaper. */
+bool repair(const Player_database &database, const Query &query_constraints,
+            Used_players &used, Partial_solution &feasible_solution) {
+  while (feasible_solution.current_price > query_constraints.total_limit) {
+    Move best;
+    double worst_efficiency = 0;
+    for (int slot = 0; slot < int(feasible_solution.players.size()); ++slot) {
+      const Lineup_player &player = feasible_solution.players[slot];
+      const Position_players &players = database[player.position];
+      double efficiency =
+          double(players.points[player.index]) /
+          max(1, players.price[player.index]);
+      if (best.size > 0 and efficiency >= worst_efficiency)
+        continue;
+      for (int j = 0; j < players.size(); ++j) {
+        if (not used[player.position][j] and
+            players.price[j] < players.price[player.index]) {
+          best.swaps[0] = {slot, j};
+          best.size = 1;
+          best.price = players.price[j] - players.price[player.index];
+          best.points = players.points[j] - players.points[player.index];
+          worst_efficiency = efficiency;
+          break;
+        }
+      }
+    }
+    if (best.size == 0)
+      return false;
+    apply_move(best, used, feasible_solution);
+  }
+  return true;
+}
+
+/* Position-aware crossover: every position keeps the players both parents
+   share, and fills its remaining slots with a random selection of the
+   players only one parent has, so the formation counts are preserved. The
+   child is then repaired into the budget. */
+bool crossover(const Player_database &database, const Query &query_constraints,
+               const Genome &a, const Genome &b, Used_players &used,
+               Partial_solution &feasible_solution, Random &random) {
+  clear_solution(used, feasible_solution);
+  for (Position position : POSITIONS) {
+    vector<uint64_t> common(a.bits[position].size()),
+        differing(a.bits[position].size());
+    for (int w = 0; w < int(common.size()); ++w) {
+      common[w] = a.bits[position][w] & b.bits[position][w];
+      differing[w] = a.bits[position][w] ^ b.bits[position][w];
+    }
+    for (int i : set_players(common))
+      add_player(database, {position, i}, used, feasible_solution);
+
+    vector<int> candidates = set_players(differing);
+    int open = query_constraints.slots[position] -
+               feasible_solution.counts[position];
+    for (int k = 0; k < open; ++k) {
+      swap(candidates[k], candidates[k + random.below(candidates.size() - k)]);
+      add_player(database, {position, candidates[k]}, used, feasible_solution);
+    }
+  }
+  return repair(database, query_constraints, used, feasible_solution);
+}
+
+/* Memetic algorithm: a population of lineups, seeded with randomised
+   constructions, evolves by breeding an offspring per member. Parents are
+   picked through binary tournaments, crossed over, mutated through a random
+   move and polished through local search; the best distinct lineups among
+   parents and offspring survive. The offspring of a generation are bred by
+   several worker threads, each with its own generator and lineup. */
+void memetic_search(const Player_database &database,
+                    const Query &query_constraints,
+                    const Price_indexes &indexes,
+                    const Efficiency_scores &efficiency, Used_players &used,
+                    Partial_solution &feasible_solution,
+                    const Mh_parameters &parameters, Random &random) {
+  const Memetic_parameters &memetic = parameters.memetic;
+  int population_size = max(2, memetic.population);
+
+  // Initial population: the start lineup and randomised constructions.
+  vector<Genome> population;
+  local_search(database, query_constraints, indexes, used, feasible_solution,
+               random);
+  if (feasible_solution.current_points > feasible_solution.best_points)
+    update_best_solution(feasible_solution);
+  population.push_back(encode(database, feasible_solution));
+  while (int(population.size()) < population_size) {
+    if (not randomised_construction(database, query_constraints, indexes,
+                                    efficiency, 1.0, used, feasible_solution,
+                                    random))
+      return;
+    local_search(database, query_constraints, indexes, used,
+                 feasible_solution, random);
+    population.push_back(encode(database, feasible_solution));
+  }
+
+  // Per worker state.
+  int n_workers = max(1, memetic.workers);
+  vector<Random> worker_random;
+  vector<Used_players> worker_used;
+  vector<Partial_solution> worker_solution(n_workers);
+  for (int w = 0; w < n_workers; ++w) {
+    worker_random.emplace_back(random.next());
+    worker_used.push_back(initialise_used_players(database));
+    worker_solution[w].best_points = feasible_solution.best_points;
+  }
+
+  double end = start_time + parameters.time_limit;
+  long long generations = 0;
+  /* Offspring of a generation and whether they were bred, as bytes rather
+     than packed bits since the workers write them concurrently. */
+  vector<Genome> offspring(population_size);
+  vector<char> bred(population_size);
+  for (; now() < end; ++generations) {
+    auto breed = [&](int w) {
+      Random &generator = worker_random[w];
+      Partial_solution &child = worker_solution[w];
+      auto tournament = [&]() -> const Genome & {
+        const Genome &a = population[generator.below(population_size)];
+        const Genome &b = population[generator.below(population_size)];
+        return a.points >= b.points ? a : b;
+      };
+      for (int k = w; k < population_size; k += n_workers) {
+        const Genome &a = tournament(), &b = tournament();
+        bred[k] = crossover(database, query_constraints, a, b, worker_used[w],
+                            child, generator);
+        if (not bred[k])
+          continue;
+        Move move;
+        if (generator.uniform() < memetic.mutation and
+            draw_move(database, query_constraints, indexes, worker_used[w],
+                      child, generator, move))
+          apply_move(move, worker_used[w], child);
+        local_search(database, query_constraints, indexes, worker_used[w],
+                     child, generator);
+        if (child.current_points > child.best_points)
+          update_best_solution(child);
+        offspring[k] = encode(database, child);
+      }
+    };
+    vector<thread> workers;
+    for (int w = 1; w < n_workers; ++w)
+      workers.emplace_back(breed, w);
+    breed(0);
+    for (thread &t : workers)
+      t.join();
+
+    // Survival of the best distinct lineups among parents and offspring.
+    for (int k = 0; k < population_size; ++k)
+      if (bred[k])
+        population.push_back(offspring[k]);
+    stable_sort(population.begin(), population.end(),
+                [](const Genome &a, const Genome &b) {
+                  return a.points > b.points;
+                });
+    vector<Genome> survivors;
+    for (const Genome &genome : population) {
+      bool duplicate = false;
+      for (const Genome &survivor : survivors)
+        duplicate = duplicate or survivor.bits == genome.bits;
+      if (not duplicate)
+        survivors.push_back(genome);
+      if (int(survivors.size()) == population_size)
+        break;
+    }
+
+    // Refills a population that lost its diversity with new constructions.
+    while (int(survivors.size()) < population_size and
+           randomised_construction(database, query_constraints, indexes,
+                                   efficiency, 1.0, used, feasible_solution,
+                                   random)) {
+      local_search(database, query_constraints, indexes, used,
+                   feasible_solution, random);
+      survivors.push_back(encode(database, feasible_solution));
+    }
+    population = survivors;
+  }
+  cerr << "Memetic generations: " << generations << endl;
+}
+
+/* Main algorithm concerning metaheuristics: greedy start, randomised unless
+   it is the first chain, and improved by the selected engine. Annealing
+   statistics are gathered if 'stats' is given. */
+void grasp_mh(const Player_database &database, const Query &query_constraints,
+              const Price_indexes &indexes,
+              const Efficiency_scores &efficiency, Used_players &used,
+              Partial_solution &feasible_solution,
+              const Mh_parameters &parameters, Random &random,
+              bool randomised_start, Annealing_stats *stats) {
+  /* Constructs the greedy lineup, taking the most efficient player that
+     leaves room for the open slots, and writes it if none is better. */
+  if (not randomised_construction(database, query_constraints, indexes,
+                                  efficiency, 0, used, feasible_solution,
+                                  random))
+    return;
+  if (randomised_start)
+    randomise_solution(database, query_constraints, indexes, used,
+                       feasible_solution, random);
+  update_best_solution(feasible_solution);
+
+  // Applies simulated annealing or tabu search.
+  if (parameters.engine == TABU)
+    tabu_search(database, query_constraints, indexes, used, feasible_solution,
+                parameters, random);
+  else if (parameters.engine == GRASP)
+    grasp_search(database, query_constraints, indexes, efficiency, used,
+                 feasible_solution, parameters, random);
+  else if (parameters.engine == MEMETIC)
+    memetic_search(database, query_constraints, indexes, efficiency, used,
+                   feasible_solution, parameters, random);
+  else
+    simulated_annealing(database, query_constraints, indexes, used,
+                        feasible_solution, parameters, random, stats);
+}
+
+/* Writes the annealing statistics of every chain as CSV, one line per
+   window: its end time, temperature, evaluated moves per second, moves
+   proposed, fraction of them rejected because the replacement was already
+   in the lineup, fraction of the candidates that did not fit in the
+   budget, evaluated moves by sign, worsening ones accepted and reheats. */
+void write_annealing_stats(const string &stats_file,
+                           const vector<Annealing_stats> &stats) {
+  ofstream out(stats_file);
+  out << "chain,time,temperature,evaluations_per_second,proposals,"
+         "used_rejected,budget_rejected,improving,worsening,"
+         "worsening_accepted,reheats"
+      << endl;
+  for (int chain = 0; chain < int(stats.size()); ++chain) {
+    for (const Annealing_window &window : stats[chain].windows) {
+      long long evaluations = window.proposals - window.used_rejections;
+      double duration = max(1e-9, window.end - window.start);
+      out << chain << "," << window.end - start_time << ","
+          << window.temperature << "," << evaluations / duration << ","
+          << window.proposals << ","
+          << double(window.used_rejections) / max(1LL, window.proposals)
+          << ","
+          << 1 - double(window.affordable) / max(1LL, window.candidates)
+          << "," << window.improving << "," << window.worsening << ","
+          << window.worsening_accepted << "," << window.reheats << endl;
+    }
+  }
 }
 
 int main(int argc, char **argv) {
@@ -456,17 +1239,81 @@ int main(int argc, char **argv) {
   query = argv[2];
   output_file = argv[3];
 
-  // Reads the input files.
+  /* Optional arguments, loaded from the configuration file (as tuned
+     offline) and overridden by the command line. */
+  Config settings = solver_settings("mh", argc, argv, 4);
+  uint64_t seed = stoull(setting(settings, "seed", "1"));
+  int n_chains = max(1.0, setting(settings, "chains", 1.0));
+  double exponent = setting(settings, "exponent", 1.0);
+
+  Mh_parameters parameters;
+  string engine = setting(settings, "engine", "annealing");
+  parameters.engine = engine == "tabu"      ? TABU
+                      : engine == "grasp"   ? GRASP
+                      : engine == "memetic" ? MEMETIC
+                                            : ANNEALING;
+  parameters.time_limit = setting(settings, "time", parameters.time_limit);
+
+  Annealing_parameters &annealing = parameters.annealing;
+  string cooling = setting(settings, "cooling", "geometric");
+  annealing.cooling = cooling == "linear"     ? LINEAR
+                      : cooling == "adaptive" ? ADAPTIVE
+                                              : GEOMETRIC;
+  annealing.final_temperature =
+      setting(settings, "final_temperature", annealing.final_temperature);
+  annealing.stagnation = setting(settings, "stagnation",
+                                 double(annealing.stagnation));
+
+  parameters.tabu.tenure =
+      max(0.0, setting(settings, "tenure", double(parameters.tabu.tenure)));
+  parameters.grasp.alpha = setting(settings, "alpha", parameters.grasp.alpha);
+  parameters.grasp.elite_size = max(
+      1.0, setting(settings, "elite", double(parameters.grasp.elite_size)));
+  parameters.memetic.population = setting(
+      settings, "population", double(parameters.memetic.population));
+  parameters.memetic.mutation =
+      setting(settings, "mutation", parameters.memetic.mutation);
+  parameters.memetic.workers =
+      setting(settings, "workers", double(parameters.memetic.workers));
+
+  // Reads the input files, sorting the players by points / price^exponent.
   Query query_constraints = read_query(query);
-  Player_database database = read_data_base(data_base, query_constraints);
-  Used_players used = initialise_used_players(database);
-
-  // Random generator seed.
-  int rs = time(NULL);
-  srand(rs);
-
-  // Algorithm execution, solution writting, and timing.
+  Player_database database =
+      read_data_base(data_base, query_constraints, exponent);
+  reduce_candidates(database, query_constraints);
+  Price_indexes indexes = build_price_indexes(
+      database, query_constraints,
+      parameters.engine == TABU ? parameters.tabu.tenure : 0);
+  Efficiency_scores efficiency = efficiency_scores(database, exponent);
+  solution_writer.start(output_file, database, setting(settings, "trace", ""));
+  solution_writer.certify(points_bound(database, query_constraints));
+
+  /* Random generators, seeded from the command line for reproducible runs:
+     every chain draws its own stream from the main one. */
+  Random random(seed);
+  vector<Random> chain_random;
+  for (int chain = 0; chain < n_chains; ++chain)
+    chain_random.emplace_back(random.next());
+
+  /* Algorithm execution, solution writting, and timing. Independent chains
+     run on their own threads, sharing only the best lineup. */
+  string stats_file = setting(settings, "stats", "");
+  vector<Annealing_stats> stats(stats_file.empty() ? 0 : n_chains);
   start_time = now();
-  Partial_solution feasible_solution;
-  grasp_mh(database, query_constraints, used, feasible_solution);
-}
\ No newline at end of file
+  auto run_chain = [&](int chain) {
+    Used_players used = initialise_used_players(database);
+    Partial_solution feasible_solution;
+    grasp_mh(database, query_constraints, indexes, efficiency, used,
+             feasible_solution, parameters, chain_random[chain], chain > 0,
+             stats.empty() ? nullptr : &stats[chain]);
+  };
+  vector<thread> chains;
+  for (int chain = 1; chain < n_chains; ++chain)
+    chains.emplace_back(run_chain, chain);
+  run_chain(0);
+  for (thread &t : chains)
+    t.join();
+  solution_writer.stop();
+  if (not stats_file.empty())
+    write_annealing_stats(stats_file, stats);
+}
@@ -0,0 +1,442 @@
+// Player Core shared by the solvers.
+//
+// Players are stored per position as a struct of arrays (price, points and
+// name id columns) indexed by the Position enum, so the search loops access
+// them in O(1) without string comparisons or copies.
+
+#ifndef PLAYERS_HH
+#define PLAYERS_HH
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Soccer player positions, in the order they are written and searched.
+enum Position { POR, DEF, MIG, DAV, N_POSITIONS };
+const array<Position, N_POSITIONS> POSITIONS = {POR, DEF, MIG, DAV};
+
+// Position names in the database and labels in the solution files.
+const array<string, N_POSITIONS> POSITION_NAMES = {"por", "def", "mig", "dav"};
+const array<string, N_POSITIONS> POSITION_LABELS = {"POR", "DEF", "MIG",
+                                                    "DAV"};
+
+// Players of a single position, stored column-wise.
+struct Position_players {
+  vector<int> price;
+  vector<int> points;
+  vector<int> name;
+
+  int size() const { return price.size(); }
+};
+
+// Definition of player database data structure.
+struct Player_database {
+  vector<string> names;
+  array<Position_players, N_POSITIONS> positions;
+
+  const Position_players &operator[](Position position) const {
+    return positions[position];
+  }
+  Position_players &operator[](Position position) {
+    return positions[position];
+  }
+};
+
+// Definition of query data structure: required players of every position.
+struct Query {
+  array<int, N_POSITIONS> slots = {1, 0, 0, 0};
+  int total_limit;
+  int player_limit;
+};
+
+// Player of a lineup, given by its position and index within it.
+struct Lineup_player {
+  Position position;
+  int index;
+};
+
+// Timing (wall-clock).
+inline double now() {
+  return chrono::duration<double>(
+             chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Maps a database position name to its position, N_POSITIONS if unknown.
+inline Position parse_position(const string &name) {
+  for (Position position : POSITIONS)
+    if (POSITION_NAMES[position] == name)
+      return position;
+  return N_POSITIONS;
+}
+
+/* Efficiency criteria used to sort the players: points / price^exponent, with
+   0-point players last (the cheapest first). By manually experimenting with
+   roots, the power function (0.35) has shown to be very effective, while mh
+   keeps the plain points/price ratio (exponent 1).
+
+   Returns the efficiency order of the given players as a permutation. Every
+   key is computed once into a column, instead of two pow() calls per
+   comparison, and the (key, index) pairs are sorted, so ties keep the input
+   order as a stable sort would. */
+inline vector<int> efficiency_permutation(const vector<int> &points,
+                                          const vector<int> &price,
+                                          double exponent) {
+  int n = points.size();
+  vector<double> key(n);
+  for (int i = 0; i < n; ++i)
+    key[i] = points[i] == 0 ? price[i] : -points[i] / pow(price[i], exponent);
+
+  // Keys sort increasingly: best efficiency first, then the 0-point players.
+  vector<pair<double, int>> scoring, scoreless;
+  for (int i = 0; i < n; ++i)
+    (points[i] == 0 ? scoreless : scoring).push_back({key[i], i});
+  sort(scoring.begin(), scoring.end());
+  sort(scoreless.begin(), scoreless.end());
+
+  vector<int> order;
+  order.reserve(n);
+  for (const auto &[k, i] : scoring)
+    order.push_back(i);
+  for (const auto &[k, i] : scoreless)
+    order.push_back(i);
+  return order;
+}
+
+// Reorders the columns of a position following the given permutation.
+inline void permute_players(Position_players &players,
+                            const vector<int> &order) {
+  Position_players sorted;
+  for (int i : order) {
+    sorted.price.push_back(players.price[i]);
+    sorted.points.push_back(players.points[i]);
+    sorted.name.push_back(players.name[i]);
+  }
+  players = sorted;
+}
+
+// Applies ordering criteria to each of the positions.
+inline void sort_players(Player_database &database, double exponent) {
+  for (Position position : POSITIONS) {
+    Position_players &players = database[position];
+    permute_players(players, efficiency_permutation(players.points,
+                                                    players.price, exponent));
+  }
+}
+
+/* Players of a position by increasing price. For every prefix of that order,
+   'top' keeps the 'depth' players with the most points, best first, so the
+   best players within a budget that are not excluded (such as the ones
+   already in a lineup, up to depth - 1) are found through a binary search. */
+struct Price_index {
+  vector<int> order;
+  vector<int> price;
+  int depth = 0;
+  vector<int> top;
+
+  // Amount of players costing at most the budget.
+  int affordable(int budget) const {
+    return upper_bound(price.begin(), price.end(), budget) - price.begin();
+  }
+
+  // Index of the r-th best of the 'count' cheapest players, -1 if none.
+  int best(int count, int r) const { return top[(count - 1) * depth + r]; }
+};
+
+// Builds the price index of a position.
+inline Price_index build_price_index(const Position_players &players,
+                                     int depth) {
+  Price_index index;
+  index.depth = depth;
+  index.order.resize(players.size());
+  iota(index.order.begin(), index.order.end(), 0);
+  stable_sort(index.order.begin(), index.order.end(), [&](int a, int b) {
+    return players.price[a] < players.price[b];
+  });
+
+  vector<int> best(depth, -1);
+  for (int i : index.order) {
+    index.price.push_back(players.price[i]);
+
+    // Inserts the player among the best ones so far, if it is one of them.
+    int r = depth;
+    while (r > 0 and (best[r - 1] == -1 or
+                      players.points[best[r - 1]] < players.points[i]))
+      --r;
+    if (r < depth) {
+      best.insert(best.begin() + r, i);
+      best.pop_back();
+    }
+    index.top.insert(index.top.end(), best.begin(), best.end());
+  }
+  return index;
+}
+
+// Price indexes of every position, used to draw affordable swaps.
+typedef array<Price_index, N_POSITIONS> Price_indexes;
+
+/* Builds the price indexes of the positions. Lineups hold up to 'slots'
+   players of a position, so keeping one more best player per prefix always
+   leaves an unused one, plus as many as can be 'excluded' otherwise. */
+inline Price_indexes build_price_indexes(const Player_database &database,
+                                         const Query &query_constraints,
+                                         int excluded) {
+  Price_indexes indexes;
+  for (Position position : POSITIONS)
+    indexes[position] = build_price_index(
+        database[position], query_constraints.slots[position] + 1 + excluded);
+  return indexes;
+}
+
+/* Players of every position merged into a single list, ordered by the same
+   efficiency criteria as the positions themselves. */
+inline vector<Lineup_player> efficiency_order(const Player_database &database,
+                                              double exponent) {
+  vector<Lineup_player> players;
+  vector<int> points, price;
+  for (Position position : POSITIONS) {
+    for (int i = 0; i < database[position].size(); ++i) {
+      players.push_back({position, i});
+      points.push_back(database[position].points[i]);
+      price.push_back(database[position].price[i]);
+    }
+  }
+
+  vector<Lineup_player> order;
+  order.reserve(players.size());
+  for (int i : efficiency_permutation(points, price, exponent))
+    order.push_back(players[i]);
+  return order;
+}
+
+/* Reads and stores the soccer player database. Discards players that surpass
+   the player limit price, and sorts every position by efficiency. */
+inline Player_database read_data_base(const string &data_base,
+                                      const Query &query_constraints,
+                                      double exponent = 0.35) {
+  Player_database database;
+
+  ifstream in(data_base);
+  while (not in.eof()) {
+    string name, position_name, team;
+    int price, points;
+
+    // Reads raw soccer player data.
+    getline(in, name, ';');
+    if (name == "")
+      break;
+    getline(in, position_name, ';');
+    in >> price;
+    char aux;
+    in >> aux;
+    getline(in, team, ';');
+    in >> points;
+    string aux2;
+    getline(in, aux2);
+
+    // Price restriction.
+    Position position = parse_position(position_name);
+    if (position != N_POSITIONS and price <= query_constraints.player_limit) {
+      database[position].price.push_back(price);
+      database[position].points.push_back(points);
+      database[position].name.push_back(database.names.size());
+      database.names.push_back(name);
+    }
+  }
+  in.close();
+
+  // Sorts database accordingly to the ordering criteria.
+  sort_players(database, exponent);
+  return database;
+}
+
+// Reads the given query. That is, player configurations and price constraints.
+inline Query read_query(const string &query) {
+  Query query_constraints;
+
+  ifstream in;
+  in.open(query);
+  in >> query_constraints.slots[DEF] >> query_constraints.slots[MIG] >>
+      query_constraints.slots[DAV] >> query_constraints.total_limit >>
+      query_constraints.player_limit;
+  in.close();
+
+  return query_constraints;
+}
+
+/* Marks the players dominated within a position: those for which at least
+   'slots' other players cost no more and score no fewer points. Some optimal
+   lineup never contains them, since at least one of their dominators is left
+   out of any lineup and can replace them. Players are visited by increasing
+   price (and decreasing points), keeping the 'slots' best points so far. */
+inline vector<bool> dominated_players(const Position_players &players,
+                                      int slots) {
+  vector<int> order(players.size());
+  iota(order.begin(), order.end(), 0);
+  sort(order.begin(), order.end(), [&](int a, int b) {
+    if (players.price[a] != players.price[b])
+      return players.price[a] < players.price[b];
+    if (players.points[a] != players.points[b])
+      return players.points[a] > players.points[b];
+    return a < b;
+  });
+
+  vector<bool> dominated(players.size(), false);
+  priority_queue<int, vector<int>, greater<int>> top_points;
+  for (int i : order) {
+    if (slots == 0 or (int(top_points.size()) == slots and
+                       top_points.top() >= players.points[i]))
+      dominated[i] = true;
+    top_points.push(players.points[i]);
+    if (int(top_points.size()) > slots)
+      top_points.pop();
+  }
+  return dominated;
+}
+
+/* Drops the dominated players of every position before the search, keeping
+   the efficiency order, and logs how many candidates each position kept. */
+inline void reduce_candidates(Player_database &database,
+                              const Query &query_constraints) {
+  cerr << "Candidates kept:";
+  for (Position position : POSITIONS) {
+    Position_players &players = database[position];
+    vector<bool> dominated =
+        dominated_players(players, query_constraints.slots[position]);
+
+    vector<int> kept;
+    for (int i = 0; i < players.size(); ++i)
+      if (not dominated[i])
+        kept.push_back(i);
+    cerr << " " << POSITION_NAMES[position] << " " << kept.size() << "/"
+         << players.size();
+    permute_players(players, kept);
+  }
+  cerr << endl;
+}
+
+// Value used for sums over more players than a position has left.
+const double INFEASIBLE = numeric_limits<double>::infinity();
+
+// Sum of the 'slots' largest values points - lambda * price of the players.
+inline double best_reduced_sum(const Position_players &players, int slots,
+                               double lambda) {
+  vector<double> values;
+  for (int i = 0; i < players.size(); ++i)
+    values.push_back(max(0.0, players.points[i] - lambda * players.price[i]));
+  if (int(values.size()) < slots)
+    return -INFEASIBLE;
+  nth_element(values.begin(), values.begin() + slots, values.end(),
+              greater<double>());
+  double sum = 0;
+  for (int k = 0; k < slots; ++k)
+    sum += values[k];
+  return sum;
+}
+
+/* Lagrangian relaxation of the budget constraint: for any multiplier lambda
+   >= 0, no lineup satisfying the query scores more than lambda * budget plus
+   the best reduced values points - lambda * price of every position. */
+inline double lagrangian_bound(const Player_database &database,
+                               const Query &query_constraints,
+                               double lambda) {
+  double bound = lambda * query_constraints.total_limit;
+  for (Position position : POSITIONS)
+    bound += best_reduced_sum(database[position],
+                              query_constraints.slots[position], lambda);
+  return bound;
+}
+
+/* Finds the multiplier minimising the Lagrangian bound of the empty lineup,
+   which is convex in lambda, through ternary search. The minimum is the LP
+   relaxation of the per-position cardinality knapsack. */
+inline double root_multiplier(const Player_database &database,
+                              const Query &query_constraints) {
+  // Beyond the best points/price ratio every reduced value is zero.
+  double low = 0, high = 0;
+  for (Position position : POSITIONS) {
+    const Position_players &players = database[position];
+    for (int i = 0; i < players.size(); ++i)
+      if (players.price[i] > 0)
+        high = max(high, double(players.points[i]) / players.price[i]);
+  }
+
+  for (int iteration = 0; iteration < 100; ++iteration) {
+    double a = low + (high - low) / 3, b = high - (high - low) / 3;
+    if (lagrangian_bound(database, query_constraints, a) <=
+        lagrangian_bound(database, query_constraints, b))
+      high = b;
+    else
+      low = a;
+  }
+  return (low + high) / 2;
+}
+
+// Points bound of the lineups written without any.
+const int NO_BOUND = -1;
+
+/* Upper bound on the points of any lineup satisfying the query: the
+   Lagrangian bound at the root multiplier, rounded down as points are
+   integers. Written next to the points of a lineup, it certifies how far
+   the lineup can be from the optimum. NO_BOUND when some position has fewer
+   players than slots, as no lineup exists then. */
+inline int points_bound(const Player_database &database,
+                        const Query &query_constraints) {
+  for (Position position : POSITIONS)
+    if (int(database[position].size()) < query_constraints.slots[position])
+      return NO_BOUND;
+  double lambda = root_multiplier(database, query_constraints);
+  return floor(lagrangian_bound(database, query_constraints, lambda) + 1e-6);
+}
+
+/* Given a lineup prints itself and its timing in the required format. It is
+   written to a temporary file that then atomically replaces the output, so a
+   solver killed meanwhile never leaves a torn solution behind. An upper
+   bound on the points of any lineup, if known, is written after the price
+   as "Cota: bound", which the checker ignores. */
+inline void write_lineup(const string &output_file,
+                         const Player_database &database,
+                         const vector<Lineup_player> &players, int points,
+                         int price, double time, int bound = NO_BOUND) {
+  string temporary_file = output_file + ".tmp";
+  ofstream out(temporary_file);
+  out.setf(ios::fixed);
+  out.precision(1);
+
+  out << time << endl;
+
+  // Writes the tactic soccer players by positions.
+  for (Position position : POSITIONS) {
+    out << POSITION_LABELS[position] << ": ";
+    bool first = true;
+    for (const Lineup_player &player : players) {
+      if (player.position != position)
+        continue;
+      if (not first)
+        out << ";";
+      out << database.names[database[position].name[player.index]];
+      first = false;
+    }
+    out << endl;
+  }
+
+  out << "Punts: " << points << endl;
+  out << "Preu: " << price << endl;
+  if (bound != NO_BOUND)
+    out << "Cota: " << bound << endl;
+
+  out.close();
+  rename(temporary_file.c_str(), output_file.c_str());
+}
+
+#endif
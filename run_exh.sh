@@ -1,7 +1,7 @@
 #!/bin/bash
 
 # Compiles the main program.
-g++ -Wall -O3 -std=c++17 exh3.cc -o exh3
+g++ -Wall -O3 -std=c++17 -pthread exh.cc -o exh
 
 # Checks whether compilation was successful.
 if [ $? -ne 0 ]; then
@@ -10,14 +10,14 @@ if [ $? -ne 0 ]; then
 fi
 
 # Path to the folder containing the query files.
-query_folder="./public_benchs"
+query_folder="./greedy/new_benchs"
 
 # List of queries.
 queries=("$query_folder/easy-1.txt" "$query_folder/easy-2.txt" "$query_folder/easy-4.txt" "$query_folder/easy-6.txt" "$query_folder/hard-1.txt" "$query_folder/hard-3.txt" "$query_folder/hard-5.txt" "$query_folder/hard-7.txt" "$query_folder/med-2.txt" "$query_folder/med-4.txt" "$query_folder/med-6.txt"
          "$query_folder/easy-3.txt" "$query_folder/easy-5.txt" "$query_folder/easy-7.txt" "$query_folder/hard-2.txt" "$query_folder/hard-4.txt" "$query_folder/hard-6.txt" "$query_folder/med-1.txt" "$query_folder/med-3.txt" "$query_folder/med-5.txt" "$query_folder/med-7.txt")
 
 # Path to program.
-program="./exh3"
+program="./exh"
 
 # Path to the database.
 database="data_base.txt"
@@ -37,5 +37,6 @@ for query in "${queries[@]}"; do
     output_file="${output_directory}/output_$(basename "$query")"
 
     # Runs your program with the current query file and saves the output to the corresponding output file.
-    timeout "$execution_duration" $program $database "$query" "$output_file"
+    # The solver stops by itself at the deadline, the timeout is only a safeguard.
+    timeout "$execution_duration" $program $database "$query" "$output_file" --deadline "$((execution_duration - 5))"
 done
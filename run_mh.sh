@@ -1,7 +1,7 @@
 #!/bin/bash
 
 # Compiles the main program.
-g++ -Wall -O3 -std=c++17 mh.cc -o mh
+g++ -Wall -O3 -std=c++17 -pthread mh.cc -o mh
 
 # Checks whether compilation was successful.
 if [ $? -ne 0 ]; then
@@ -10,7 +10,7 @@ if [ $? -ne 0 ]; then
 fi
 
 # Path to the folder containing the query files.
-query_folder="./public_benchs"
+query_folder="./greedy/new_benchs"
 
 # List of queries.
 queries=("$query_folder/easy-1.txt" "$query_folder/easy-2.txt" "$query_folder/easy-4.txt" "$query_folder/easy-6.txt" "$query_folder/hard-1.txt" "$query_folder/hard-3.txt" "$query_folder/hard-5.txt" "$query_folder/hard-7.txt" "$query_folder/med-2.txt" "$query_folder/med-4.txt" "$query_folder/med-6.txt"
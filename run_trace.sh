@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Compiles the solvers and the report tool.
+g++ -Wall -O3 -std=c++17 -pthread greedy.cc -o greedy_solver && \
+g++ -Wall -O3 -std=c++17 -pthread exh.cc -o exh && \
+g++ -Wall -O3 -std=c++17 -pthread mh.cc -o mh && \
+g++ -Wall -O3 -std=c++17 trace_report.cc -o trace_report
+
+# Checks whether compilation was successful.
+if [ $? -ne 0 ]; then
+    echo "Compilation failed. Exiting."
+    exit 1
+fi
+
+# Path to the folder containing the query files.
+query_folder="./greedy/new_benchs"
+
+# Path to the database.
+database="data_base.txt"
+
+# Output and trace directories, one trace folder per solver.
+output_directory="output_files"
+trace_directory="traces"
+
+# Time limit for each execution (in seconds).
+execution_duration=${1:-10}
+
+mkdir -p "$output_directory"
+for solver in greedy exh mh; do
+    mkdir -p "$trace_directory/$solver"
+done
+
+# Runs every solver on every query, tracing its incumbents.
+for query in "$query_folder"/*.txt; do
+    name=$(basename "$query" .txt)
+    output_file="${output_directory}/output_$(basename "$query")"
+    echo "Running $query..."
+
+    timeout "$execution_duration" ./greedy_solver $database "$query" "$output_file" --trace "$trace_directory/greedy/$name.csv"
+    timeout "$execution_duration" ./exh $database "$query" "$output_file" --deadline "$execution_duration" --trace "$trace_directory/exh/$name.csv" 2> /dev/null
+    timeout "$((execution_duration + 1))" ./mh $database "$query" "$output_file" --time "$execution_duration" --trace "$trace_directory/mh/$name.csv"
+done
+
+# Time-to-target curves and primal integrals of the solvers.
+./trace_report "$execution_duration" "$trace_directory"/greedy "$trace_directory"/exh "$trace_directory"/mh
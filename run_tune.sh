@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Compiles the solvers and the tuner.
+g++ -Wall -O3 -std=c++17 -pthread greedy.cc -o greedy_solver && \
+g++ -Wall -O3 -std=c++17 -pthread mh.cc -o mh && \
+g++ -Wall -O3 -std=c++17 tune.cc -o tune
+
+# Checks whether compilation was successful.
+if [ $? -ne 0 ]; then
+    echo "Compilation failed. Exiting."
+    exit 1
+fi
+
+# Path to the folder containing the query files.
+query_folder="./greedy/new_benchs"
+
+# Path to the database.
+database="data_base.txt"
+
+# Configuration file loaded by the solvers at startup.
+config_file="solvers.cfg"
+
+# Time budget of every metaheuristic run (in seconds).
+time_budget=${1:-1}
+
+# Races the configurations of each solver, writing the winners. The greedy
+# exponent is raced on single runs (--portfolio 0), the portfolio staying on
+# by default with the tuned exponent as its first variant.
+./tune greedy ./greedy_solver $database "$query_folder" "$time_budget" "$config_file"
+./tune mh ./mh $database "$query_folder" "$time_budget" "$config_file"
@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Compiles the main program.
+g++ -Wall -O3 -std=c++17 -pthread exh.cc -o exh
+
+# Checks whether compilation was successful.
+if [ $? -ne 0 ]; then
+    echo "Compilation failed. Exiting."
+    exit 1
+fi
+
+# Path to the folder containing the query files.
+query_folder="./greedy/new_benchs"
+
+# List of queries.
+queries=("$query_folder/easy-1.txt" "$query_folder/easy-2.txt" "$query_folder/easy-4.txt" "$query_folder/easy-6.txt" "$query_folder/hard-1.txt" "$query_folder/hard-3.txt" "$query_folder/hard-5.txt" "$query_folder/hard-7.txt" "$query_folder/med-2.txt" "$query_folder/med-4.txt" "$query_folder/med-6.txt"
+         "$query_folder/easy-3.txt" "$query_folder/easy-5.txt" "$query_folder/easy-7.txt" "$query_folder/hard-2.txt" "$query_folder/hard-4.txt" "$query_folder/hard-6.txt" "$query_folder/med-1.txt" "$query_folder/med-3.txt" "$query_folder/med-5.txt" "$query_folder/med-7.txt")
+
+# Path to program.
+program="./exh"
+
+# Path to the database.
+database="data_base.txt"
+
+# Warm start source: "greedy" or a previous solution file.
+warm_start="${1:-greedy}"
+
+# Output directory.
+output_directory="output_files"
+
+# Creates the output directory if it doesn't exist.
+mkdir -p "$output_directory"
+
+# Time limit for each execution (in seconds).
+execution_duration=180  # 3 minutes.
+
+# Visited nodes reported by the search.
+nodes() {
+    grep "Nodes:" | awk '{print $2}'
+}
+
+# Runs every query cold and warm started, and compares their visited nodes.
+total_cold=0
+total_warm=0
+for query in "${queries[@]}"; do
+    output_file="${output_directory}/output_$(basename "$query")"
+
+    cold=$(timeout "$execution_duration" $program $database "$query" "$output_file" 2>&1 | nodes)
+    warm=$(timeout "$execution_duration" $program $database "$query" "$output_file" --warm-start "$warm_start" 2>&1 | nodes)
+
+    echo "$(basename "$query"): cold $cold nodes, warm $warm nodes, saved $((cold - warm))"
+    total_cold=$((total_cold + cold))
+    total_warm=$((total_warm + warm))
+done
+echo "Total: cold $total_cold nodes, warm $total_warm nodes, saved $((total_cold - total_warm))"
@@ -0,0 +1,115 @@
+// Asynchronous Solution Writer.
+//
+// Search loops publish every improved lineup to a single lock-free slot and
+// go on; a background thread takes the latest one and writes it. Lineups
+// published while the previous write is in progress replace each other in
+// the slot, so bursts of improvements only cost one write. Optionally, every
+// published lineup is also traced, and the writer appends the pending trace
+// points to the trace file. A bound on the points, once certified, is written
+// with the lineups, rewriting the last one if it was written without it.
+
+#ifndef SOLUTION_WRITER_HH
+#define SOLUTION_WRITER_HH
+
+#include "players.hh"
+#include "trace.hh"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+using namespace std;
+
+// Lineup waiting to be written, with its points, price and timing.
+struct Lineup_record {
+  vector<Lineup_player> players;
+  int points;
+  int price;
+  double time;
+};
+
+class Solution_writer {
+public:
+  ~Solution_writer() { stop(); }
+
+  /* Starts the writer thread, tracing the published lineups if a trace file
+     is given. The database must outlive the writer. */
+  void start(const string &output_file, const Player_database &database,
+             const string &trace_file = "") {
+    this->output_file = output_file;
+    this->database = &database;
+    this->trace_file = trace_file;
+    if (not trace_file.empty())
+      start_trace(trace_file);
+    closing = false;
+    writer = thread(&Solution_writer::run, this);
+  }
+
+  /* Publishes a lineup without any file I/O, dropping the previously
+     published one if it has not been written yet. */
+  void publish(const Lineup_record &record) {
+    if (not trace_file.empty()) {
+      lock_guard<mutex> guard(trace_lock);
+      trace.push_back({record.time, record.points, record.price});
+    }
+    delete slot.exchange(new Lineup_record(record));
+  }
+
+  // Certifies an upper bound on the points, written with the lineups.
+  void certify(int bound) { this->bound = bound; }
+
+  // Writes the last published lineup, if pending, and stops the thread.
+  void stop() {
+    if (not writer.joinable())
+      return;
+    closing = true;
+    writer.join();
+  }
+
+private:
+  string output_file;
+  string trace_file;
+  const Player_database *database = nullptr;
+  mutex trace_lock;
+  vector<Trace_point> trace;
+  atomic<Lineup_record *> slot{nullptr};
+  atomic<bool> closing{false};
+  atomic<int> bound{NO_BOUND};
+  thread writer;
+
+  /* Writes the published lineups until stopped and nothing is pending,
+     and the last one again whenever the bound changes. */
+  void run() {
+    unique_ptr<Lineup_record> written;
+    int written_bound = NO_BOUND;
+    while (true) {
+      bool last_round = closing;
+      flush_trace();
+      Lineup_record *record = slot.exchange(nullptr);
+      if (record != nullptr) {
+        written.reset(record);
+      } else if (written == nullptr or written_bound == bound) {
+        if (last_round)
+          return;
+        this_thread::sleep_for(chrono::milliseconds(1));
+        continue;
+      }
+      written_bound = bound;
+      write_lineup(output_file, *database, written->players, written->points,
+                   written->price, written->time, written_bound);
+    }
+  }
+
+  // Appends the pending trace points to the trace file.
+  void flush_trace() {
+    vector<Trace_point> pending;
+    {
+      lock_guard<mutex> guard(trace_lock);
+      pending.swap(trace);
+    }
+    if (not pending.empty())
+      append_trace(trace_file, pending);
+  }
+};
+
+#endif
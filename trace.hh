@@ -0,0 +1,37 @@
+// Incumbent Traces.
+//
+// A trace is a CSV file with a line per improved lineup, used to compare the
+// solvers by how early they reach good lineups (see trace_report.cc).
+
+#ifndef TRACE_HH
+#define TRACE_HH
+
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Incumbent improvement of a trace: wall time since the start, points, price.
+struct Trace_point {
+  double time;
+  int points;
+  int price;
+};
+
+// Creates (or empties) a trace file, as CSV with its header.
+inline void start_trace(const string &trace_file) {
+  ofstream out(trace_file);
+  out << "time,points,price" << endl;
+}
+
+// Appends incumbent improvements to a trace file.
+inline void append_trace(const string &trace_file,
+                         const vector<Trace_point> &trace) {
+  ofstream out(trace_file, ios::app);
+  out.setf(ios::fixed);
+  out.precision(6);
+  for (const Trace_point &point : trace)
+    out << point.time << "," << point.points << "," << point.price << endl;
+}
+
+#endif
@@ -0,0 +1,152 @@
+// Trace Report.
+//
+// Aggregates the incumbent traces written by the solvers (--trace) over the
+// bench queries. Traces are grouped by their folder, one folder per solver,
+// and named after their query; the reference of a query is the best points
+// reached by any of its traces. For every solver it reports:
+//
+// - Time-to-target curves: the fraction of queries whose incumbent is within
+//   a relative gap of the reference at every time of a logarithmic grid.
+// - Primal integral: the integral over [0, time_limit] of the primal gap
+//   (reference - points) / reference, where the gap is 1 until the first
+//   incumbent, averaged over the queries. Lower is better: it rewards both
+//   reaching good lineups and reaching them early.
+//
+// Usage: trace_report time_limit trace_folder...
+
+#include "players.hh"
+#include "trace.hh"
+
+#include <filesystem>
+#include <map>
+#include <sstream>
+using namespace std;
+
+// Relative gaps of the time-to-target curves.
+const vector<double> TARGETS = {0.05, 0.01, 0.001, 0};
+
+// Trace of a solver on a query.
+struct Trace {
+  string solver;
+  string query;
+  vector<Trace_point> points;
+};
+
+// Reads a trace file, skipping its header.
+Trace read_trace(const filesystem::path &path) {
+  Trace trace = {path.parent_path().filename().string(), path.stem().string(),
+                 {}};
+  ifstream in(path);
+  string line;
+  getline(in, line);
+  while (getline(in, line)) {
+    replace(line.begin(), line.end(), ',', ' ');
+    istringstream fields(line);
+    Trace_point point;
+    if (fields >> point.time >> point.points >> point.price)
+      trace.points.push_back(point);
+  }
+  return trace;
+}
+
+// Primal gap of an incumbent, 1 without any.
+double primal_gap(int points, int reference) {
+  if (points < 0 or reference <= 0)
+    return 1;
+  return double(reference - points) / reference;
+}
+
+// Best points of the trace reached by the given time, or -1.
+int incumbent(const Trace &trace, double time) {
+  int points = -1;
+  for (const Trace_point &point : trace.points)
+    if (point.time <= time)
+      points = max(points, point.points);
+  return points;
+}
+
+// Integral of the primal gap of the trace over [0, time_limit].
+double primal_integral(const Trace &trace, int reference, double time_limit) {
+  double integral = 0, time = 0;
+  int points = -1;
+  for (const Trace_point &point : trace.points) {
+    if (point.time >= time_limit)
+      break;
+    integral += primal_gap(points, reference) * (point.time - time);
+    time = max(time, point.time);
+    points = max(points, point.points);
+  }
+  return integral + primal_gap(points, reference) * (time_limit - time);
+}
+
+// Logarithmic time grid, from a millisecond up to the time limit.
+vector<double> time_grid(double time_limit) {
+  vector<double> grid;
+  for (double decade = 0.001; decade < time_limit; decade *= 10)
+    for (double step : {1, 2, 5})
+      if (decade * step < time_limit)
+        grid.push_back(decade * step);
+  grid.push_back(time_limit);
+  return grid;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    cout << "Syntax: " << argv[0] << " time_limit trace_folder..." << endl;
+    exit(1);
+  }
+  double time_limit = stod(argv[1]);
+
+  // Traces, sorted by solver and query.
+  vector<Trace> traces;
+  for (int i = 2; i < argc; ++i)
+    for (const auto &entry : filesystem::directory_iterator(argv[i]))
+      if (entry.path().extension() == ".csv")
+        traces.push_back(read_trace(entry.path()));
+  sort(traces.begin(), traces.end(), [](const Trace &a, const Trace &b) {
+    return make_pair(a.solver, a.query) < make_pair(b.solver, b.query);
+  });
+
+  map<string, int> reference;
+  map<string, vector<const Trace *>> solvers;
+  for (const Trace &trace : traces) {
+    reference[trace.query] =
+        max(reference[trace.query], incumbent(trace, time_limit));
+    solvers[trace.solver].push_back(&trace);
+  }
+
+  // Time-to-target curves, as CSV.
+  vector<double> grid = time_grid(time_limit);
+  cout << "solver,target";
+  for (double time : grid)
+    cout << "," << time;
+  cout << endl;
+  for (const auto &[solver, solver_traces] : solvers) {
+    for (double target : TARGETS) {
+      cout << solver << "," << target;
+      for (double time : grid) {
+        int reached = 0;
+        for (const Trace *trace : solver_traces)
+          if (primal_gap(incumbent(*trace, time), reference[trace->query]) <=
+              target)
+            ++reached;
+        cout << "," << double(reached) / solver_traces.size();
+      }
+      cout << endl;
+    }
+  }
+
+  // Primal integrals, averaged over the queries.
+  cout << endl << "solver,queries,primal_integral,final_gap" << endl;
+  for (const auto &[solver, solver_traces] : solvers) {
+    double integral = 0, final_gap = 0;
+    for (const Trace *trace : solver_traces) {
+      int best = reference[trace->query];
+      integral += primal_integral(*trace, best, time_limit);
+      final_gap += primal_gap(incumbent(*trace, time_limit), best);
+    }
+    cout << solver << "," << solver_traces.size() << ","
+         << integral / solver_traces.size() << ","
+         << final_gap / solver_traces.size() << endl;
+  }
+}
@@ -0,0 +1,256 @@
+// Offline Hyperparameter Tuner.
+//
+// Races candidate configurations of a solver over the bench queries. Every
+// surviving candidate runs the solver on one instance (a query and a seed) at
+// a time, under a fixed time budget, and is scored by the points it reaches
+// minus the fraction of the budget it took to reach them. Once enough
+// instances have been raced, candidates whose scores are significantly worse
+// than those of the best candidate (one-sided paired t-test, 95%) are
+// eliminated. The winner is written as the solver section of the
+// configuration file the solvers load at startup, keeping the other
+// sections. The greedy exponent is raced with the portfolio off, since the
+// portfolio tries every exponent anyway; the tuned one becomes both the
+// exponent of single runs and the first variant of the portfolio.
+//
+// Usage: tune greedy|mh program data_base.txt query_folder [time_budget]
+//             [config_file]
+// where program is the compiled solver.
+
+#include "config.hh"
+#include "players.hh"
+
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+using namespace std;
+
+// Candidate configuration: its settings and the scores of its instances.
+struct Candidate {
+  Config settings;
+  vector<double> scores;
+  bool alive = true;
+
+  double mean() const {
+    return accumulate(scores.begin(), scores.end(), 0.0) / scores.size();
+  }
+};
+
+// Instance of the race: a query and the seed the solver runs with.
+struct Instance {
+  string query;
+  int seed;
+};
+
+// Instances raced before any candidate can be eliminated.
+const int MIN_INSTANCES = 5;
+
+/* Settings every candidate of a solver runs with, passed on the command line
+   and never written to the configuration file. */
+Config fixed_settings(const string &section) {
+  if (section == "greedy")
+    return {{"portfolio", "0"}};
+  return {};
+}
+
+// Files used to run the candidates.
+const string CANDIDATE_CONFIG = "tune_candidate.cfg";
+const string CANDIDATE_OUTPUT = "tune_output.txt";
+
+/* One-sided 95% critical values of Student's t distribution, by degrees of
+   freedom, and the normal one beyond the table. */
+double t_critical(int degrees) {
+  static const vector<double> table = {
+      6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+      1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725,
+      1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697};
+  return degrees <= int(table.size()) ? table[degrees - 1] : 1.645;
+}
+
+// Candidate configurations of greedy: the efficiency exponent.
+vector<Candidate> greedy_candidates() {
+  vector<Candidate> candidates;
+  for (int step = 0; step <= 20; ++step) {
+    ostringstream exponent;
+    exponent << step * 0.05;
+    candidates.push_back({{{"exponent", exponent.str()}}, {}});
+  }
+  return candidates;
+}
+
+/* Candidate configurations of mh: its defaults and a seeded random sample of
+   the hyperparameter space. */
+vector<Candidate> mh_candidates(int samples) {
+  const vector<pair<string, vector<string>>> space = {
+      {"engine", {"annealing", "tabu", "grasp", "memetic"}},
+      {"exponent", {"0.35", "0.5", "1"}},
+      {"cooling", {"geometric", "linear", "adaptive"}},
+      {"final_temperature", {"0.05", "0.1", "0.2", "0.5", "1"}},
+      {"stagnation", {"50000", "200000", "1000000"}},
+      {"tenure", {"5", "10", "20", "40"}},
+      {"alpha", {"0.1", "0.3", "0.6", "1"}},
+      {"elite", {"5", "10", "20"}},
+      {"population", {"10", "30", "60"}},
+      {"mutation", {"0.1", "0.2", "0.5"}}};
+
+  vector<Candidate> candidates = {{{}, {}}};
+  mt19937 generator(1);
+  for (int sample = 0; sample < samples; ++sample) {
+    Candidate candidate;
+    for (const auto &[key, values] : space)
+      candidate.settings[key] = values[generator() % values.size()];
+    candidates.push_back(candidate);
+  }
+  return candidates;
+}
+
+// Settings of a candidate, as a single line.
+string describe(const Config &settings) {
+  string description;
+  for (const auto &[key, value] : settings)
+    description += key + "=" + value + " ";
+  return description.empty() ? "(defaults)" : description;
+}
+
+/* Runs the solver with the candidate settings on an instance, and returns
+   its score: points minus the fraction of the budget taken to reach them. */
+double run(const string &program, const string &section,
+           const string &data_base, const Candidate &candidate,
+           const Instance &instance, double budget) {
+  ofstream config(CANDIDATE_CONFIG);
+  for (const auto &[key, value] : candidate.settings)
+    config << section << "." << key << " " << value << endl;
+  config.close();
+  remove(CANDIDATE_OUTPUT.c_str());
+
+  ostringstream command;
+  command << "timeout " << budget + 2 << " " << program << " " << data_base
+          << " " << instance.query << " " << CANDIDATE_OUTPUT << " --config "
+          << CANDIDATE_CONFIG << " --seed " << instance.seed << " --time "
+          << budget;
+  for (const auto &[key, value] : fixed_settings(section))
+    command << " --" << key << " " << value;
+  command << " 2> /dev/null";
+  if (system(command.str().c_str()) == -1)
+    return 0;
+
+  ifstream out(CANDIDATE_OUTPUT);
+  double time;
+  string line;
+  int points = 0;
+  if (not(out >> time))
+    return 0;
+  while (getline(out, line))
+    if (line.compare(0, 7, "Punts: ") == 0)
+      points = stoi(line.substr(7));
+  return points - min(time, budget) / budget;
+}
+
+// Eliminates the candidates significantly worse than the best one.
+void eliminate(vector<Candidate> &candidates) {
+  int best = -1;
+  for (int c = 0; c < int(candidates.size()); ++c)
+    if (candidates[c].alive and
+        (best == -1 or candidates[c].mean() > candidates[best].mean()))
+      best = c;
+
+  for (Candidate &candidate : candidates) {
+    if (not candidate.alive or &candidate == &candidates[best])
+      continue;
+    int n = candidate.scores.size();
+    vector<double> differences;
+    for (int i = 0; i < n; ++i)
+      differences.push_back(candidates[best].scores[i] - candidate.scores[i]);
+    double mean = accumulate(differences.begin(), differences.end(), 0.0) / n;
+    double variance = 0;
+    for (double difference : differences)
+      variance += (difference - mean) * (difference - mean) / (n - 1);
+
+    if (variance == 0)
+      candidate.alive = mean <= 0;
+    else
+      candidate.alive = mean / sqrt(variance / n) <= t_critical(n - 1);
+  }
+}
+
+/* Writes the winner settings as the solver section of the configuration
+   file, keeping the settings of the other solvers. */
+void write_config(const string &config_file, const string &section,
+                  const Config &settings) {
+  Config config;
+  for (const auto &[key, value] : read_config(config_file))
+    if (key.compare(0, section.size() + 1, section + ".") != 0)
+      config[key] = value;
+  for (const auto &[key, value] : settings)
+    config[section + "." + key] = value;
+
+  ofstream out(config_file);
+  out << "# Solver settings, written by the tune tool." << endl;
+  for (const auto &[key, value] : config)
+    out << key << " " << value << endl;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 5) {
+    cout << "Syntax: " << argv[0]
+         << " greedy|mh program data_base.txt query_folder [time_budget]"
+            " [config_file]"
+         << endl;
+    exit(1);
+  }
+  string solver = argv[1];
+  string program = argv[2];
+  string data_base = argv[3];
+  string query_folder = argv[4];
+  double budget = argc > 5 ? stod(argv[5]) : 1.0;
+  string config_file = argc > 6 ? argv[6] : DEFAULT_CONFIG_FILE;
+
+  // Greedy is deterministic, while mh is raced over several seeds.
+  vector<Candidate> candidates =
+      solver == "greedy" ? greedy_candidates() : mh_candidates(16);
+  int rounds = solver == "greedy" ? 1 : 3;
+
+  vector<string> queries;
+  for (const auto &entry : filesystem::directory_iterator(query_folder))
+    queries.push_back(entry.path().string());
+  sort(queries.begin(), queries.end());
+  vector<Instance> instances;
+  for (int round = 1; round <= rounds; ++round)
+    for (const string &query : queries)
+      instances.push_back({query, round});
+
+  // Race.
+  for (int i = 0; i < int(instances.size()); ++i) {
+    int alive = 0;
+    for (Candidate &candidate : candidates) {
+      if (not candidate.alive)
+        continue;
+      candidate.scores.push_back(run(program, solver, data_base, candidate,
+                                     instances[i], budget));
+      ++alive;
+    }
+    if (i + 1 >= MIN_INSTANCES)
+      eliminate(candidates);
+    cerr << "Instance " << i + 1 << "/" << instances.size() << " ("
+         << instances[i].query << ", seed " << instances[i].seed
+         << "): " << alive << " candidates raced" << endl;
+    if (alive == 1)
+      break;
+  }
+  remove(CANDIDATE_CONFIG.c_str());
+  remove(CANDIDATE_OUTPUT.c_str());
+
+  // Winner: the best mean score among the survivors.
+  const Candidate *winner = nullptr;
+  for (const Candidate &candidate : candidates)
+    if (candidate.alive and
+        (winner == nullptr or candidate.mean() > winner->mean()))
+      winner = &candidate;
+  for (const Candidate &candidate : candidates)
+    if (candidate.alive)
+      cout << (&candidate == winner ? "* " : "  ") << candidate.mean() << " "
+           << describe(candidate.settings) << endl;
+
+  write_config(config_file, solver, winner->settings);
+  cout << "Written to " << config_file << ": " << describe(winner->settings)
+       << endl;
+}